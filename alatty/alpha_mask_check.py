@@ -0,0 +1,92 @@
+#!/usr/bin/env python
+# License: GPLv3 Copyright: 2026, alatty contributors
+
+# Differential checking and benchmarking of the kernels that blend glyph alpha
+# masks into the canvas. Every SIMD kernel the CPU supports is run on random
+# masks, canvases, rectangles and strides and its output must be identical to
+# that of the scalar kernel.
+
+import random
+import sys
+import time
+from typing import List, Tuple
+
+Rect = Tuple[int, int, int, int]
+
+
+def random_bytes(rng: random.Random, n: int) -> bytes:
+    return rng.getrandbits(8 * n).to_bytes(n, 'little')
+
+
+def random_rect(rng: random.Random, width: int, height: int) -> Rect:
+    # rectangles may be empty or inverted, which must blend nothing
+    return rng.randint(0, width), rng.randint(0, height), rng.randint(0, width), rng.randint(0, height)
+
+
+def check(kernel: str, rng: random.Random) -> bool:
+    from .fast_data_types import test_render_alpha_mask
+    src_stride, src_height = rng.randint(1, 80), rng.randint(1, 40)
+    dest_stride, dest_height = rng.randint(1, 80), rng.randint(1, 40)
+    mask = random_bytes(rng, src_stride * src_height)
+    canvas = random_bytes(rng, 4 * dest_stride * dest_height)
+    src_rect, dest_rect = random_rect(rng, src_stride, src_height), random_rect(rng, dest_stride, dest_height)
+    expected, actual = bytearray(canvas), bytearray(canvas)
+    test_render_alpha_mask('scalar', mask, expected, src_rect, dest_rect, src_stride, dest_stride)
+    test_render_alpha_mask(kernel, mask, actual, src_rect, dest_rect, src_stride, dest_stride)
+    if expected != actual:
+        print(f'{kernel}: differs from scalar for src_rect={src_rect} dest_rect={dest_rect} src_stride={src_stride} dest_stride={dest_stride}',
+              file=sys.stderr)
+        return False
+    return True
+
+
+def benchmark(kernel: str, width: int, height: int, repeat: int) -> float:
+    ' Return the time in seconds taken to blend a width x height mask repeat times '
+    from .fast_data_types import test_render_alpha_mask
+    rng = random.Random(0)
+    mask, canvas = random_bytes(rng, width * height), bytearray(random_bytes(rng, 4 * width * height))
+    rect = 0, 0, width, height
+    st = time.monotonic()
+    test_render_alpha_mask(kernel, mask, canvas, rect, rect, width, width, repeat)
+    return time.monotonic() - st
+
+
+usage = '''\
+usage: alatty +alpha-mask-check [--iterations N] [--seed SEED] [--repeat N]
+
+Check that every alpha mask blending kernel supported by this CPU produces
+exactly the same output as the scalar kernel on N random inputs, then time
+each kernel blending a cell sized and a large glyph mask --repeat times.'''
+
+
+def main(args: List[str]) -> None:
+    from .fast_data_types import supported_alpha_mask_kernels
+    iterations, seed, repeat = 100000, 0, 100000
+    it = iter(args[1:])
+    try:
+        for arg in it:
+            if arg in ('-h', '--help'):
+                raise SystemExit(usage)
+            if arg == '--iterations':
+                iterations = int(next(it))
+            elif arg == '--seed':
+                seed = int(next(it))
+            elif arg == '--repeat':
+                repeat = int(next(it))
+            else:
+                raise SystemExit(usage)
+    except (StopIteration, ValueError):
+        raise SystemExit(usage)
+    kernels = supported_alpha_mask_kernels()
+    num_failures = 0
+    for kernel in kernels[1:]:
+        rng = random.Random(seed)
+        num_failures += sum(not check(kernel, rng) for i in range(iterations))
+    print(f'Checked {len(kernels) - 1} kernels against scalar on {iterations} inputs each')
+    for width, height, n in ((12, 24, repeat), (256, 256, max(1, repeat // 200))):
+        print(f'{width}x{height} mask blended {n} times:')
+        for kernel in kernels:
+            print(f'  {kernel:8} {benchmark(kernel, width, height, n) * 1000:8.1f} ms')
+    if num_failures:
+        raise SystemExit(f'{num_failures} inputs produced different output')
+
@@ -769,8 +769,7 @@ def default_bg_changed_for(self, window_id: int) -> None:
         if w is not None:
             tm = self.os_window_map.get(w.os_window_id)
             if tm is not None:
-                tm.update_tab_bar_data()
-                tm.mark_tab_bar_dirty()
+                tm.invalidate_tab_bar()
                 t = tm.tab_for_id(w.tab_id)
                 if t is not None:
                     t.relayout_borders()
@@ -1183,9 +1182,20 @@ def paste_to_active_window(self, text: str) -> None:
             if w is not None:
                 w.paste_with_actions(text)
 
+    def paste_clipboard_to_window(self, cp: Clipboard, w: Optional[Window]) -> None:
+        # The clipboard is read asynchronously, the window may be closed in the meantime
+        if w is None:
+            return
+        window_id = w.id
+
+        def paste(text: str) -> None:
+            w = self.window_id_map.get(window_id)
+            if w is not None and text:
+                w.paste_with_actions(text)
+        cp.get_text_async(paste)
+
     def paste_from_clipboard(self) -> None:
-        text = get_clipboard_string()
-        self.paste_to_active_window(text)
+        self.paste_clipboard_to_window(self.clipboard, self.active_window)
 
     def current_primary_selection(self) -> str:
         return get_primary_selection() if supports_primary_selection else ''
@@ -1194,8 +1204,7 @@ def current_primary_selection_or_clipboard(self) -> str:
         return get_primary_selection() if supports_primary_selection else get_clipboard_string()
 
     def paste_from_selection(self) -> None:
-        text = self.current_primary_selection_or_clipboard()
-        self.paste_to_active_window(text)
+        self.paste_clipboard_to_window(self.primary_selection if supports_primary_selection else self.clipboard, self.active_window)
 
     def set_primary_selection(self) -> None:
         w = self.active_window
@@ -1242,13 +1251,13 @@ def copy_to_buffer(self, buffer_name: str) -> None:
 
     def paste_from_buffer(self, buffer_name: str) -> None:
         if buffer_name == 'clipboard':
-            text: Optional[str] = get_clipboard_string()
+            self.paste_clipboard_to_window(self.clipboard, self.active_window)
         elif buffer_name == 'primary':
-            text = get_primary_selection()
+            self.paste_clipboard_to_window(self.primary_selection, self.active_window)
         else:
             text = self.get_clipboard_buffer(buffer_name)
-        if text:
-            self.paste_to_active_window(text)
+            if text:
+                self.paste_to_active_window(text)
 
     def goto_tab(self, tab_num: int) -> None:
         tm = self.active_tab_manager
@@ -1628,8 +1637,9 @@ def _move_window_to(
                     else:
                         return
 
-            for detached_window in src_tab.detach_window(window):
-                target_tab.attach_window(detached_window)
+            with target_tab.batched_relayout():
+                for detached_window in src_tab.detach_window(window):
+                    target_tab.attach_window(detached_window)
             self._cleanup_tab_after_window_removal(src_tab)
             target_tab.make_active()
 
@@ -8,7 +8,7 @@ layout(std140) uniform CellRenderData {
 
     uint default_fg, default_bg, highlight_fg, highlight_bg, cursor_fg, cursor_bg, inverted;
 
-    uint xnum, ynum, cursor_fg_sprite_idx;
+    uint xnum, ynum, row_offset, cursor_fg_sprite_idx;
     float cursor_x, cursor_y, cursor_w;
 
     uint color_table[NUM_COLORS + MARK_MASK + MARK_MASK + 2];
@@ -127,6 +127,8 @@ CellData set_vertex_position() {
     /* The current cell being rendered */
     uint r = instance_id / xnum;
     uint c = instance_id - r * xnum;
+    // rows are stored as a ring starting at row_offset
+    r = (r + ynum - row_offset) % ynum;
 
     /* The position of this vertex, at a corner of the cell  */
     float left = xstart + c * dx;
@@ -20,6 +20,13 @@
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <signal.h>
+#include <stdatomic.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#ifdef SYS_pidfd_open
+#define HAS_PIDFD
+#endif
+#endif
 extern PyTypeObject Screen_Type;
 
 #if defined(__APPLE__) || defined(__OpenBSD__)
@@ -39,7 +46,7 @@ extern PyTypeObject Screen_Type;
 #endif
 #define USE_RENDER_FRAMES (global_state.has_render_frames && OPT(sync_to_monitor))
 
-static void (*parse_func)(Screen*, PyObject*, monotonic_t);
+static void (*parse_func)(Screen*, PyObject*, monotonic_t, monotonic_t);
 
 typedef struct {
     char *data;
@@ -59,18 +66,22 @@ typedef struct {
     Message *messages;
     size_t messages_capacity, messages_count;
     LoopData io_loop_data;
+    // Set from when the I/O thread is woken up until it starts its next
+    // iteration, wakeups in between are redundant and are not written
+    atomic_bool io_loop_wakeup_pending;
+    atomic_uint_fast64_t io_loop_wakeups_requested, io_loop_wakeups_written;
 } ChildMonitor;
 
 
 typedef struct {
     Screen *screen;
     bool needs_removal;
-    int fd;
+    int fd, pidfd;
     unsigned long id;
     pid_t pid;
 } Child;
 
-static const Child EMPTY_CHILD = {0};
+static const Child EMPTY_CHILD = {.pidfd = -1};
 #define screen_mutex(op, which) \
     pthread_mutex_##op(&screen->which##_buf_lock);
 #define children_mutex(op) \
@@ -83,7 +94,8 @@ static Child children[MAX_CHILDREN] = {{0}};
 static Child scratch[MAX_CHILDREN] = {{0}};
 static Child add_queue[MAX_CHILDREN] = {{0}}, remove_queue[MAX_CHILDREN] = {{0}}, remove_notify[MAX_CHILDREN] = {{0}};
 static size_t add_queue_count = 0, remove_queue_count = 0;
-static struct pollfd children_fds[MAX_CHILDREN + EXTRA_FDS] = {{0}};
+// The child pty fds followed by the child pidfds, if any
+static struct pollfd children_fds[2 * MAX_CHILDREN + EXTRA_FDS] = {{0}};
 static pthread_mutex_t children_lock, talk_lock;
 static bool kill_signal_received = false, reload_config_signal_received = false;
 static ChildMonitor *the_monitor = NULL;
@@ -93,10 +105,8 @@ typedef struct {
     int status;
 } ReapedPID;
 
-static pid_t monitored_pids[256] = {0};
-static size_t monitored_pids_count = 0;
-static ReapedPID reaped_pids[arraysz(monitored_pids)] = {{0}};
-static size_t reaped_pids_count = 0;
+static struct { pid_t *items; size_t count, capacity; } monitored_pids = {0};
+static struct { ReapedPID *items; size_t count, capacity; } reaped_pids = {0};
 
 
 
@@ -204,8 +214,11 @@ dealloc(ChildMonitor* self) {
     }
     while (add_queue_count) {
         add_queue_count--;
+        if (add_queue[add_queue_count].pidfd > -1) safe_close(add_queue[add_queue_count].pidfd, __FILE__, __LINE__);
         FREE_CHILD(add_queue[add_queue_count]);
     }
+    free(monitored_pids.items); free(reaped_pids.items);
+    memset(&monitored_pids, 0, sizeof(monitored_pids)); memset(&reaped_pids, 0, sizeof(reaped_pids));
     free_loop_data(&self->io_loop_data);
     Py_TYPE(self)->tp_free((PyObject*)self);
 }
@@ -221,8 +234,18 @@ handled_signals(ChildMonitor *self, PyObject *args UNUSED) {
     return ans;
 }
 
+static PyObject*
+io_loop_wakeup_stats(ChildMonitor *self, PyObject *args UNUSED) {
+    return Py_BuildValue("{sK sK}",
+        "requested", (unsigned long long)atomic_load_explicit(&self->io_loop_wakeups_requested, memory_order_relaxed),
+        "written", (unsigned long long)atomic_load_explicit(&self->io_loop_wakeups_written, memory_order_relaxed));
+}
+
 static void
 wakeup_io_loop(ChildMonitor *self, bool in_signal_handler) {
+    atomic_fetch_add_explicit(&self->io_loop_wakeups_requested, 1, memory_order_relaxed);
+    if (atomic_exchange(&self->io_loop_wakeup_pending, true)) return;
+    atomic_fetch_add_explicit(&self->io_loop_wakeups_written, 1, memory_order_relaxed);
     wakeup_loop(&self->io_loop_data, in_signal_handler, "io_loop");
 }
 
@@ -256,6 +279,19 @@ wakeup(ChildMonitor *self, PyObject *args UNUSED) {
     Py_RETURN_NONE;
 }
 
+static int
+open_pidfd(pid_t pid) {
+    // A pidfd becomes readable when the process exits, letting the I/O
+    // thread learn about the death of each child without relying on SIGCHLD.
+    // Returns -1 if not supported by the OS or running kernel.
+#ifdef HAS_PIDFD
+    return syscall(SYS_pidfd_open, pid, 0);
+#else
+    (void)pid;
+    return -1;
+#endif
+}
+
 static PyObject *
 add_child(ChildMonitor *self, PyObject *args) {
 #define add_child_doc "add_child(id, pid, fd, screen) -> Add a child."
@@ -268,6 +304,7 @@ add_child(ChildMonitor *self, PyObject *args) {
         return NULL;
     }
 #undef A
+    add_queue[add_queue_count].pidfd = open_pidfd(add_queue[add_queue_count].pid);
     INCREF_CHILD(add_queue[add_queue_count]);
     add_queue_count++;
     children_mutex(unlock);
@@ -389,8 +426,12 @@ shutdown_monitor(ChildMonitor *self, PyObject *a UNUSED) {
     Py_RETURN_NONE;
 }
 
+#define PARSE_TIME_BUDGET ms_to_monotonic_t(8ll)
+#define RECENT_KEY_INPUT_INTERVAL s_to_monotonic_t(1ll)
+static size_t parse_round_robin_start = 0;
+
 static bool
-do_parse(ChildMonitor *self, Screen *screen, monotonic_t now, bool flush) {
+do_parse(ChildMonitor *self, Screen *screen, monotonic_t now, bool flush, monotonic_t deadline) {
     bool input_read = false;
     screen_mutex(lock, read);
     if (screen->read_buf_sz || screen->pending_mode.used) {
@@ -398,8 +439,9 @@ do_parse(ChildMonitor *self, Screen *screen, monotonic_t now, bool flush) {
         if (flush || time_since_new_input >= OPT(input_delay)) {
             bool read_buf_full = screen->read_buf_sz >= READ_BUF_SZ;
             input_read = true;
-            parse_func(screen, self->dump_callback, now);
+            parse_func(screen, self->dump_callback, now, flush ? 0 : deadline);
             if (read_buf_full) wakeup_io_loop(self, false);  // Ensure the read fd has POLLIN set
+            if (screen->read_buf_sz) set_maximum_wait(0);  // parse budget exhausted, resume on the next tick
             screen->new_input_at = 0;
             if (screen->pending_mode.activated_at) {
                 monotonic_t time_since_pending = MAX(0, now - screen->pending_mode.activated_at);
@@ -464,6 +506,7 @@ parse_input(ChildMonitor *self) {
         for (size_t i = 0; i < msgs_count; i++) {
             Message *msg = msgs + i;
             send_response_to_peer(msg->peer_id, NULL, 0);
+            free(msg->data);
         }
         free(msgs); msgs = NULL;
     }
@@ -472,19 +515,30 @@ parse_input(ChildMonitor *self) {
         // must be done while no locks are held, since the locks are non-recursive and
         // the python function could call into other functions in this module
         remove_count--;
-        if (remove_notify[remove_count].screen) do_parse(self, remove_notify[remove_count].screen, now, true);
+        if (remove_notify[remove_count].screen) do_parse(self, remove_notify[remove_count].screen, now, true, 0);
         PyObject *t = PyObject_CallFunction(self->death_notify, "k", remove_notify[remove_count].id);
         if (t == NULL) PyErr_Print();
         else Py_DECREF(t);
         FREE_CHILD(remove_notify[remove_count]);
     }
 
-    for (size_t i = 0; i < count; i++) {
-        if (!scratch[i].needs_removal) {
-            if (do_parse(self, scratch[i].screen, now, false)) input_read = true;
+    // Parsing is limited to PARSE_TIME_BUDGET per tick so that a window being
+    // flooded with output cannot delay everything else. Every window parses at
+    // least one chunk per tick, windows that have focus or recent keyboard input
+    // go first and the rest take turns going first.
+    const monotonic_t deadline = now + PARSE_TIME_BUDGET;
+    for (unsigned pass = 0; pass < 2; pass++) {
+        for (size_t n = 0; n < count; n++) {
+            Child *c = scratch + (parse_round_robin_start + n) % count;
+            const Screen *s = c->screen;
+            const bool has_priority = s->has_focus || (s->last_key_input_at && now - s->last_key_input_at < RECENT_KEY_INPUT_INTERVAL);
+            if (has_priority == (pass == 0) && !c->needs_removal) {
+                if (do_parse(self, c->screen, now, false, deadline)) input_read = true;
+            }
         }
-        DECREF_CHILD(scratch[i]);
     }
+    if (count) parse_round_robin_start = (parse_round_robin_start + 1) % count;
+    for (size_t i = 0; i < count; i++) DECREF_CHILD(scratch[i]);
     if (reload_config_called) {
         call_boss(load_config_file, "");
     }
@@ -831,25 +885,19 @@ sig_queue(PyObject *self UNUSED, PyObject *args) {
 static PyObject*
 monitor_pid(PyObject *self UNUSED, PyObject *args) {
     int pid;
-    bool ok = true;
     if (!PyArg_ParseTuple(args, "i", &pid)) return NULL;
     children_mutex(lock);
-    if (monitored_pids_count >= arraysz(monitored_pids)) {
-        PyErr_SetString(PyExc_RuntimeError, "Too many monitored pids");
-        ok = false;
-    } else {
-        monitored_pids[monitored_pids_count++] = pid;
-    }
+    ensure_space_for(&monitored_pids, items, pid_t, monitored_pids.count + 1, capacity, 16, false);
+    monitored_pids.items[monitored_pids.count++] = pid;
     children_mutex(unlock);
-    if (!ok) return NULL;
     Py_RETURN_NONE;
 }
 
 static void
 report_reaped_pids(void) {
     children_mutex(lock);
-    if (reaped_pids_count) {
-        reaped_pids_count = 0;
+    if (reaped_pids.count) {
+        reaped_pids.count = 0;
     }
     children_mutex(unlock);
 }
@@ -1195,6 +1243,7 @@ hangup(pid_t pid) {
 static void
 cleanup_child(ssize_t i) {
     safe_close(children[i].fd, __FILE__, __LINE__);
+    if (children[i].pidfd > -1) { safe_close(children[i].pidfd, __FILE__, __LINE__); children[i].pidfd = -1; }
     hangup(children[i].pid);
 }
 
@@ -1298,13 +1347,12 @@ mark_child_for_removal(ChildMonitor *self, pid_t pid) {
 static void
 mark_monitored_pids(pid_t pid, int status) {
     children_mutex(lock);
-    for (ssize_t i = monitored_pids_count - 1; i >= 0; i--) {
-        if (pid == monitored_pids[i]) {
-            if (reaped_pids_count < arraysz(reaped_pids)) {
-                reaped_pids[reaped_pids_count].status = status;
-                reaped_pids[reaped_pids_count++].pid = pid;
-            }
-            remove_i_from_array(monitored_pids, (size_t)i, monitored_pids_count);
+    for (ssize_t i = monitored_pids.count - 1; i >= 0; i--) {
+        if (pid == monitored_pids.items[i]) {
+            ensure_space_for(&reaped_pids, items, ReapedPID, reaped_pids.count + 1, capacity, 16, false);
+            reaped_pids.items[reaped_pids.count].status = status;
+            reaped_pids.items[reaped_pids.count++].pid = pid;
+            remove_i_from_array(monitored_pids.items, (size_t)i, monitored_pids.count);
         }
     }
     children_mutex(unlock);
@@ -1326,6 +1374,22 @@ reap_children(ChildMonitor *self, bool enable_close_on_child_death) {
     }
 }
 
+static void
+reap_exited_child(size_t i, bool enable_close_on_child_death) {
+    // The pidfd of the child at i is readable, so it has exited. Reap just
+    // this child, the pidfd stays readable so stop polling it.
+    int status;
+    pid_t pid = children[i].pid, ret;
+    children_mutex(lock);
+    safe_close(children[i].pidfd, __FILE__, __LINE__);
+    children[i].pidfd = -1;
+    if (enable_close_on_child_death) children[i].needs_removal = true;
+    children_mutex(unlock);
+    while ((ret = waitpid(pid, &status, WNOHANG)) == -1 && errno == EINTR);
+    // ret is -1 with ECHILD if a SIGCHLD triggered waitpid() got to it first
+    if (ret == pid) mark_monitored_pids(pid, status);
+}
+
 #ifdef ALATTY_PRINT_BYTES_SENT_TO_CHILD
 static void
 print_text(const unsigned char *text, ssize_t sz) {
@@ -1381,7 +1445,7 @@ write_to_child(int fd, Screen *screen) {
 static void*
 io_loop(void *data) {
     // The I/O thread loop
-    size_t i;
+    size_t i, num_fds;
     int ret;
     bool has_more, data_received, has_pending_wakeups = false;
     monotonic_t last_main_loop_wakeup_at = -1, now = -1;
@@ -1390,12 +1454,21 @@ io_loop(void *data) {
     set_thread_name("AlattyChildMon");
 
     while (LIKELY(!self->shutting_down)) {
+        // Cleared before any state is examined so that a change made after
+        // this point is always followed by a new wakeup
+        atomic_store(&self->io_loop_wakeup_pending, false);
         children_mutex(lock);
         remove_children(self);
         add_children(self);
         children_mutex(unlock);
         data_received = false;
-        for (i = 0; i < self->count + EXTRA_FDS; i++) children_fds[i].revents = 0;
+        num_fds = EXTRA_FDS + self->count;
+        for (i = 0; i < self->count; i++) {
+            children_fds[num_fds + i].fd = children[i].pidfd;
+            children_fds[num_fds + i].events = POLLIN;
+        }
+        num_fds += self->count;
+        for (i = 0; i < num_fds; i++) children_fds[i].revents = 0;
         for (i = 0; i < self->count; i++) {
             screen = children[i].screen;
             /* printf("i:%lu id:%lu fd: %d read_buf_sz: %lu write_buf_used: %lu\n", i, children[i].id, children[i].fd, screen->read_buf_sz, screen->write_buf_used); */
@@ -1406,13 +1479,21 @@ io_loop(void *data) {
         if (has_pending_wakeups) {
             now = monotonic();
             monotonic_t time_delta = OPT(input_delay) - (now - last_main_loop_wakeup_at);
-            if (time_delta >= 0) ret = poll(children_fds, self->count + EXTRA_FDS, monotonic_t_to_ms(time_delta));
+            if (time_delta >= 0) ret = poll(children_fds, num_fds, monotonic_t_to_ms(time_delta));
             else ret = 0;
         } else {
-            ret = poll(children_fds, self->count + EXTRA_FDS, -1);
+            ret = poll(children_fds, num_fds, -1);
         }
         if (ret > 0) {
             if (children_fds[0].revents && POLLIN) drain_fd(children_fds[0].fd); // wakeup
+            // Reap children whose pidfds report exit before handling SIGCHLD
+            // so that the waitpid() scan there only has non-window processes left
+            for (i = 0; i < self->count; i++) {
+                if (children_fds[EXTRA_FDS + self->count + i].revents & POLLIN) {
+                    data_received = true;
+                    reap_exited_child(i, OPT(close_on_child_death));
+                }
+            }
             if (children_fds[1].revents && POLLIN) {
                 SignalSet ss = {0};
                 data_received = true;
@@ -1448,7 +1529,7 @@ io_loop(void *data) {
                 }
             }
 #ifdef DEBUG_POLL_EVENTS
-            for (i = 0; i < self->count + EXTRA_FDS; i++) {
+            for (i = 0; i < num_fds; i++) {
 #define P(w) if (children_fds[i].revents & w) printf("i:%lu %s\n", i, #w);
                 P(POLLIN); P(POLLPRI); P(POLLOUT); P(POLLERR); P(POLLHUP); P(POLLNVAL);
 #undef P
@@ -1606,7 +1687,7 @@ write_to_peer(Peer *peer) {
     else if (n < 0) {
         if (errno != EINTR) { log_error("write() to peer socket failed with error: %s", strerror(errno)); peer->write.used = 0; peer->write.failed = true; }
     } else {
-        if ((size_t)n > peer->write.used) memmove(peer->write.data, peer->write.data + n, peer->write.used - n);
+        if ((size_t)n < peer->write.used) memmove(peer->write.data, peer->write.data + n, peer->write.used - n);
         peer->write.used -= n;
     }
     talk_mutex(unlock);
@@ -1714,7 +1795,6 @@ talk_loop(void *data) {
                         p->read.finished = true;
                         p->write.failed = true; p->write.used = 0;
                     }
-                    break;
                 }
             }
         } else if (ret < 0) { if (errno != EAGAIN && errno != EINTR) perror("poll() on talk fds failed"); }
@@ -1768,6 +1848,7 @@ static PyMethodDef methods[] = {
     METHOD(mark_for_close, METH_VARARGS)
     METHOD(resize_pty, METH_VARARGS)
     METHODB(handled_signals, METH_NOARGS),
+    METHODB(io_loop_wakeup_stats, METH_NOARGS),
     {"set_iutf8_winid", (PyCFunction)pyset_iutf8, METH_VARARGS, ""},
     {NULL}  /* Sentinel */
 };
@@ -16,6 +16,7 @@
     OSC,
     get_boss,
     get_clipboard_mime,
+    get_clipboard_mime_async,
     get_options,
     set_clipboard_data_types,
 )
@@ -100,6 +101,24 @@ def get_text(self) -> str:
         self.get_mime("text/plain", parts.append)
         return b''.join(parts).decode('utf-8', 'replace')
 
+    def get_text_async(self, callback: Callable[[str], None]) -> None:
+        parts: List[bytes] = []
+
+        def on_done(ok: bool) -> None:
+            callback(b''.join(parts).decode('utf-8', 'replace'))
+        self.get_mime_async("text/plain", parts.append, on_done)
+
+    def write_own_data(self, mime: str, output: Callable[[bytes], None]) -> None:
+        data = self.data.get(mime, b'')
+        if isinstance(data, bytes):
+            output(data)
+        else:
+            chunker = data()
+            q = b' '
+            while q:
+                q = chunker()
+                output(q)
+
     def get_mime(self, mime: str, output: Callable[[bytes], None]) -> None:
         if self.enabled:
             try:
@@ -107,15 +126,22 @@ def get_mime(self, mime: str, output: Callable[[bytes], None]) -> None:
             except RuntimeError as err:
                 if str(err) != 'is_self_offer':
                     raise
-                data = self.data.get(mime, b'')
-                if isinstance(data, bytes):
-                    output(data)
-                else:
-                    chunker = data()
-                    q = b' '
-                    while q:
-                        q = chunker()
-                        output(q)
+                self.write_own_data(mime, output)
+
+    def get_mime_async(self, mime: str, output: Callable[[bytes], None], on_done: Callable[[bool], None]) -> None:
+        # Data is read from the event loop so that a slow or hung clipboard
+        # owner cannot freeze the UI. on_done is called once all data has been
+        # passed to output, possibly before this method returns.
+        if not self.enabled:
+            on_done(False)
+            return
+
+        def done(ok: bool, is_self_offer: bool) -> None:
+            if is_self_offer:
+                self.write_own_data(mime, output)
+                ok = True
+            on_done(ok)
+        get_clipboard_mime_async(self.clipboard_type, mime, output, done)
 
     def get_mime_data(self, mime: str) -> bytes:
         ans: List[bytes] = []
@@ -134,6 +160,16 @@ def get_available_mime_types_for_paste(self) -> Tuple[str, ...]:
             return tuple(x.decode('utf-8', 'replace') for x in uniq(parts))
         return ()
 
+    def get_available_mime_types_for_paste_async(self, callback: Callable[[Tuple[str, ...]], None]) -> None:
+        if not self.enabled:
+            callback(())
+            return
+        parts: List[bytes] = []
+
+        def done(ok: bool, is_self_offer: bool) -> None:
+            callback(tuple(self.data) if is_self_offer else tuple(x.decode('utf-8', 'replace') for x in uniq(parts)))
+        get_clipboard_mime_async(self.clipboard_type, None, parts.append, done)
+
     def __call__(self, mime: str) -> Callable[[], bytes]:
         data = self.data.get(mime, b'')
         if isinstance(data, str):
@@ -448,28 +484,42 @@ def fulfill_read_request(self, rr: ReadRequest, allowed: bool = True) -> None:
             return
         w.screen.send_escape_code_to_child(OSC, rr.encode_response(status='OK'))
 
+        # The clipboard is read asynchronously, one mime type at a time, and
+        # the window may be closed in the meantime
+        window_id = self.window_id
+        mime_types = iter(rr.mime_types)
         current_mime = ''
 
+        def send_response(status: str = 'DATA', mime: str = '', payload: bytes = b'') -> None:
+            w = get_boss().window_id_map.get(window_id)
+            if w is not None:
+                w.screen.send_escape_code_to_child(OSC, rr.encode_response(status=status, mime=mime, payload=payload))
+
         def write_chunks(data: bytes) -> None:
-            assert w is not None
             mv = memoryview(data)
             while mv:
-                w.screen.send_escape_code_to_child(OSC, rr.encode_response(payload=mv[:4096], mime=current_mime))
+                send_response(payload=mv[:4096], mime=current_mime)
                 mv = mv[4096:]
 
-        for mime in rr.mime_types:
-            current_mime = mime
-            if mime == TARGETS_MIME:
-                payload = ' '.join(cp.get_available_mime_types_for_paste()).encode('utf-8')
-                if payload:
-                    payload += b'\n'
-                w.screen.send_escape_code_to_child(OSC, rr.encode_response(payload=payload, mime=current_mime))
-                continue
-            try:
-                cp.get_mime(mime, write_chunks)
-            except Exception as e:
-                log_error(f'Failed to read requested mime type {mime} with error: {e}')
-        w.screen.send_escape_code_to_child(OSC, rr.encode_response(status='DONE'))
+        def send_targets(available_mime_types: Tuple[str, ...]) -> None:
+            payload = ' '.join(available_mime_types).encode('utf-8')
+            if payload:
+                payload += b'\n'
+            send_response(payload=payload, mime=current_mime)
+            read_next()
+
+        def read_next(ok: bool = True) -> None:
+            nonlocal current_mime
+            for mime in mime_types:
+                current_mime = mime
+                if mime == TARGETS_MIME:
+                    cp.get_available_mime_types_for_paste_async(send_targets)
+                else:
+                    cp.get_mime_async(mime, write_chunks, read_next)
+                return
+            send_response(status='DONE')
+
+        read_next()
 
     def reject_read_request(self, rr: ReadRequest) -> None:
         if rr.protocol_type is ProtocolType.osc_52:
@@ -480,13 +530,20 @@ def reject_read_request(self, rr: ReadRequest) -> None:
 
     def fulfill_legacy_read_request(self, rr: ReadRequest, allowed: bool = True) -> None:
         cp = get_boss().primary_selection if rr.is_primary_selection else get_boss().clipboard
-        w = get_boss().window_id_map.get(self.window_id)
-        if w is not None:
-            text = ''
-            if cp.enabled and allowed:
-                text = cp.get_text()
-            loc = 'p' if rr.is_primary_selection else 'c'
-            w.screen.send_escape_code_to_child(OSC, encode_osc52(loc, text))
+        if self.window_id not in get_boss().window_id_map:
+            return
+        window_id = self.window_id
+        loc = 'p' if rr.is_primary_selection else 'c'
+
+        def send_text(text: str) -> None:
+            w = get_boss().window_id_map.get(window_id)
+            if w is not None:
+                w.screen.send_escape_code_to_child(OSC, encode_osc52(loc, text))
+
+        if cp.enabled and allowed:
+            cp.get_text_async(send_text)
+        else:
+            send_text('')
 
     def ask_to_read_clipboard(self, rr: ReadRequest) -> None:
         if rr.mime_types == (TARGETS_MIME,):
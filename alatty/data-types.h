@@ -246,20 +246,36 @@ typedef struct {
     GPUCell *gpu_cell_buf;
     CPUCell *cpu_cell_buf;
     index_type xnum, ynum, *line_map, *scratch;
-    LineAttrs *line_attrs;
+    LineAttrs *line_attrs, *scratch_attrs;
     Line *line;
 } LineBuf;
 
+typedef struct HistoryLine HistoryLine;
+
 typedef struct {
     GPUCell *gpu_cells;
     CPUCell *cpu_cells;
     LineAttrs *line_attrs;
+    // Used instead of the cell arrays when deduplicating, references to shared line payloads
+    HistoryLine **lines;
+    // Size of the mmapped cell storage, pages are committed lazily on first write
+    size_t storage_sz;
 } HistoryBufSegment;
 
+typedef struct {
+    size_t num_bytes;
+    // upper bound on the number of cells this line occupies, used to skip wrapping lines that fit
+    index_type max_cells;
+} PagerHistoryLine;
+
 typedef struct {
     void *ringbuf;
     size_t maximum_size;
-    bool rewrap_needed;
+    // Index of the logical (unwrapped) lines in ringbuf, the last line is the one currently being written
+    struct {
+        PagerHistoryLine *items;
+        size_t first, count, capacity, num_bytes;
+    } lines;
 } PagerHistoryBuf;
 
 typedef struct {
@@ -275,6 +291,7 @@ typedef struct {
     PagerHistoryBuf *pagerhist;
     Line *line;
     index_type start_of_data, count;
+    bool deduplicate;
 } HistoryBuf;
 
 typedef struct {
@@ -373,7 +390,7 @@ attrs_to_cursor(const CellAttrs attrs, Cursor *c) {
 Line* alloc_line(void);
 Cursor* alloc_cursor(void);
 LineBuf* alloc_linebuf(unsigned int, unsigned int);
-HistoryBuf* alloc_historybuf(unsigned int, unsigned int, unsigned int);
+HistoryBuf* alloc_historybuf(unsigned int, unsigned int, unsigned int, bool);
 ColorProfile* alloc_color_profile(void);
 void copy_color_profile(ColorProfile*, ColorProfile*);
 PyObject* create_256_color_table(void);
@@ -41,6 +41,16 @@ def run_kitten(args: List[str]) -> None:
     rk(kitten)
 
 
+def parser_check(args: List[str]) -> None:
+    from alatty.parser_check import main
+    main(args)
+
+
+def alpha_mask_check(args: List[str]) -> None:
+    from alatty.alpha_mask_check import main
+    main(args)
+
+
 def namespaced(args: List[str]) -> None:
     try:
         func = namespaced_entry_points[args[1]]
@@ -60,6 +70,8 @@ def namespaced(args: List[str]) -> None:
 namespaced_entry_points = {k: v for k, v in entry_points.items() if k[0] not in '+@'}
 namespaced_entry_points['launch'] = launch
 namespaced_entry_points['kitten'] = run_kitten
+namespaced_entry_points['parser-check'] = parser_check
+namespaced_entry_points['alpha-mask-check'] = alpha_mask_check
 
 
 def setup_openssl_environment(ext_dir: str) -> None:
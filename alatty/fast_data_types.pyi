@@ -8,6 +8,7 @@ from typing import (
     List,
     NewType,
     Optional,
+    Sequence,
     Tuple,
     TypedDict,
     Union,
@@ -289,6 +290,12 @@ def encode_key_for_tty(
     pass
 
 
+def inject_input(
+    window_id: int, events: Sequence[Union['KeyEvent', str, bytes]], synthesize_release_events: bool = False
+) -> Optional[int]:
+    pass
+
+
 def log_error_string(s: str) -> None:
     pass
 
@@ -786,6 +793,17 @@ def set_active_window(os_window_id: int, tab_id: int, window_id: int) -> None:
     pass
 
 
+def supported_alpha_mask_kernels() -> Tuple[str, ...]:
+    pass
+
+
+def test_render_alpha_mask(
+    kernel: str, alpha_mask: bytes, dest: Union[bytearray, memoryview], src_rect: Tuple[int, int, int, int],
+    dest_rect: Tuple[int, int, int, int], src_stride: int, dest_stride: int, repeat: int = 1
+) -> None:
+    pass
+
+
 def concat_cells(cell_width: int, cell_height: int, is_32_bit: bool, cells: Tuple[bytes, ...]) -> bytes:
     pass
 
@@ -904,12 +922,25 @@ def get_fallback_font(text: str) -> Any:
     pass
 
 
+class HistoryBufMemoryUsage(TypedDict):
+    deduplicate: bool
+    segment_bytes: int
+    resident_bytes: int
+    line_bytes: int
+    shared_lines: int
+    pool_payloads: int
+    pool_bytes: int
+
+
 class HistoryBuf:
 
-    def pagerhist_as_text(self, upto_output_start: bool = False) -> str:
+    def pagerhist_as_text(self, upto_output_start: bool = False, add_wrap_markers: bool = True) -> str:
+        pass
+
+    def pagerhist_as_bytes(self, upto_output_start: bool = False, add_wrap_markers: bool = True) -> bytes:
         pass
 
-    def pagerhist_as_bytes(self) -> bytes:
+    def memory_usage(self) -> HistoryBufMemoryUsage:
         pass
 
 
@@ -1073,6 +1104,8 @@ class Screen:
 
     def bell(self) -> None: ...
 
+def parse_bytes(screen: Screen, data: bytes) -> None: ...
+
 def set_tab_bar_render_data(
     os_window_id: int, screen: Screen, left: int, top: int, right: int, bottom: int
 ) -> None:
@@ -1109,6 +1142,9 @@ class ChildMonitor:
     def handled_signals(self) -> Tuple[int, ...]:
         pass
 
+    def io_loop_wakeup_stats(self) -> Dict[str, int]:
+        pass
+
     def main_loop(self) -> None:
         pass
 
@@ -1334,6 +1370,9 @@ def set_use_os_log(yes: bool) -> None: ...
 def clearenv() -> None: ...
 def set_clipboard_data_types(ct: int, mime_types: Tuple[str, ...]) -> None: ...
 def get_clipboard_mime(ct: int, mime: Optional[str], callback: Callable[[bytes], None]) -> None: ...
+def get_clipboard_mime_async(
+    ct: int, mime: Optional[str], output: Callable[[bytes], None], on_done: Callable[[bool, bool], None]
+) -> None: ...
 def run_with_activation_token(func: Callable[[str], None]) -> None: ...
 def make_x11_window_a_dock_window(x11_window_id: int, strut: Tuple[int, int, int, int, int, int, int, int, int, int, int, int]) -> None: ...
 def unicode_database_version() -> Tuple[int, int, int]: ...
@@ -263,6 +263,26 @@ sprite_tracker_current_layout(FONTS_DATA_HANDLE data, unsigned int *x, unsigned
     *x = fg->sprite_tracker.xnum; *y = fg->sprite_tracker.ynum; *z = fg->sprite_tracker.z;
 }
 
+// Compute the size of a sprite texture that can hold used_ynum rows of sprites
+// in each of used_layers layers. The size grows geometrically from the
+// currently allocated ynum and num_layers, so that filling the texture needs a
+// logarithmic rather than linear number of reallocations, each of which copies
+// the whole texture. Returns false if the allocated size is already enough.
+bool
+sprite_texture_size_for_growth(unsigned int used_ynum, unsigned int used_layers, unsigned int max_ynum, unsigned int max_layers, unsigned int *ynum, unsigned int *num_layers) {
+    if (used_ynum <= *ynum && used_layers <= *num_layers) return false;
+    if (used_ynum > *ynum) *ynum = MAX(used_ynum, MIN(max_ynum, 2 * *ynum));
+    if (used_layers > *num_layers) *num_layers = MAX(used_layers, MIN(max_layers, 2 * *num_layers));
+    return true;
+}
+
+bool
+sprite_tracker_texture_size(FONTS_DATA_HANDLE data, unsigned int *ynum, unsigned int *num_layers) {
+    FontGroup *fg = (FontGroup*)data;
+    return sprite_texture_size_for_growth(
+        fg->sprite_tracker.ynum, fg->sprite_tracker.z + 1, fg->sprite_tracker.max_y, MIN((size_t)UINT16_MAX, max_array_len), ynum, num_layers);
+}
+
 
 static void
 sprite_tracker_set_layout(GPUSpriteTracker *sprite_tracker, unsigned int cell_width, unsigned int cell_height) {
@@ -562,18 +582,166 @@ END_ALLOW_CASE_RANGE
 
 static PyObject* box_drawing_function = NULL, *prerender_function = NULL, *descriptor_for_idx = NULL;
 
-void
-render_alpha_mask(const uint8_t *alpha_mask, pixel* dest, Region *src_rect, Region *dest_rect, size_t src_stride, size_t dest_stride) {
-    for (size_t sr = src_rect->top, dr = dest_rect->top; sr < src_rect->bottom && dr < dest_rect->bottom; sr++, dr++) {
-        pixel *d = dest + dest_stride * dr;
-        const uint8_t *s = alpha_mask + src_stride * sr;
-        for(size_t sc = src_rect->left, dc = dest_rect->left; sc < src_rect->right && dc < dest_rect->right; sc++, dc++) {
-            uint8_t src_alpha = d[dc] & 0xff;
-            uint8_t alpha = s[sc];
-            d[dc] = 0xffffff00 | MAX(alpha, src_alpha);
+// Alpha mask blending {{{
+// Each kernel blends one row: the alpha of every destination pixel becomes the
+// max of its alpha and the mask value, and all its color channels become 0xff.
+// Kernels only differ in how many pixels they handle per step.
+
+typedef void (*blend_alpha_mask_row_func)(pixel *restrict d, const uint8_t *restrict s, size_t width);
+
+static void
+blend_alpha_mask_row_scalar(pixel *restrict d, const uint8_t *restrict s, size_t width) {
+    for (size_t c = 0; c < width; c++) d[c] = 0xffffff00 | MAX((pixel)s[c], d[c] & 0xff);
+}
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#define HAS_SSE2_ALPHA_MASK_KERNEL
+
+// The alpha is the low byte of each pixel, so a bytewise max against the zero
+// extended mask values computes it, and the or discards the other bytes
+static void
+blend_alpha_mask_row_sse2(pixel *restrict d, const uint8_t *restrict s, size_t width) {
+    const __m128i zero = _mm_setzero_si128(), color = _mm_set1_epi32((int)0xffffff00);
+    size_t c = 0;
+    for (; c + 16 <= width; c += 16) {
+        const __m128i mask = _mm_loadu_si128((const __m128i*)(s + c));
+        const __m128i lo = _mm_unpacklo_epi8(mask, zero), hi = _mm_unpackhi_epi8(mask, zero);
+        const __m128i alphas[4] = {
+            _mm_unpacklo_epi16(lo, zero), _mm_unpackhi_epi16(lo, zero), _mm_unpacklo_epi16(hi, zero), _mm_unpackhi_epi16(hi, zero)};
+        for (unsigned i = 0; i < arraysz(alphas); i++) {
+            __m128i *p = (__m128i*)(d + c + 4 * i);
+            _mm_storeu_si128(p, _mm_or_si128(_mm_max_epu8(_mm_loadu_si128(p), alphas[i]), color));
         }
     }
+    // glyphs are often narrower than 16 pixels, so handle the rest four at a time
+    for (; c + 4 <= width; c += 4) {
+        int32_t mask; memcpy(&mask, s + c, sizeof(mask));
+        const __m128i alphas = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(mask), zero), zero);
+        __m128i *p = (__m128i*)(d + c);
+        _mm_storeu_si128(p, _mm_or_si128(_mm_max_epu8(_mm_loadu_si128(p), alphas), color));
+    }
+    blend_alpha_mask_row_scalar(d + c, s + c, width - c);
+}
+
+#if defined(__x86_64__) && (defined(__clang__) || __GNUC__ >= 5)
+#define HAS_AVX2_ALPHA_MASK_KERNEL
+
+__attribute__((target("avx2"))) static void
+blend_alpha_mask_row_avx2(pixel *restrict d, const uint8_t *restrict s, size_t width) {
+    const __m256i color = _mm256_set1_epi32((int)0xffffff00);
+    size_t c = 0;
+    for (; c + 16 <= width; c += 16) {
+        const __m256i a1 = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(s + c)));
+        const __m256i a2 = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(s + c + 8)));
+        __m256i *p1 = (__m256i*)(d + c), *p2 = (__m256i*)(d + c + 8);
+        _mm256_storeu_si256(p1, _mm256_or_si256(_mm256_max_epu8(_mm256_loadu_si256(p1), a1), color));
+        _mm256_storeu_si256(p2, _mm256_or_si256(_mm256_max_epu8(_mm256_loadu_si256(p2), a2), color));
+    }
+    if (c + 8 <= width) {
+        const __m256i a = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(s + c)));
+        __m256i *p = (__m256i*)(d + c);
+        _mm256_storeu_si256(p, _mm256_or_si256(_mm256_max_epu8(_mm256_loadu_si256(p), a), color));
+        c += 8;
+    }
+    if (c + 4 <= width) {
+        int32_t mask; memcpy(&mask, s + c, sizeof(mask));
+        __m128i *p = (__m128i*)(d + c);
+        _mm_storeu_si128(p, _mm_or_si128(_mm_max_epu8(_mm_loadu_si128(p), _mm_cvtepu8_epi32(_mm_cvtsi32_si128(mask))), _mm256_castsi256_si128(color)));
+        c += 4;
+    }
+    // The compiler does not clear the upper halves of the AVX registers before
+    // calling into non AVX code from a target("avx2") function, without this
+    // every row pays for a transition between AVX and SSE code
+    _mm256_zeroupper();
+    blend_alpha_mask_row_scalar(d + c, s + c, width - c);
 }
+#endif
+#endif
+
+#if defined(__aarch64__) || (defined(__ARM_NEON) && defined(__arm__))
+#include <arm_neon.h>
+#define HAS_NEON_ALPHA_MASK_KERNEL
+
+static void
+blend_alpha_mask_row_neon(pixel *restrict d, const uint8_t *restrict s, size_t width) {
+    const uint32x4_t color = vdupq_n_u32(0xffffff00), alpha = vdupq_n_u32(0xff);
+    size_t c = 0;
+    for (; c + 16 <= width; c += 16) {
+        const uint8x16_t mask = vld1q_u8(s + c);
+        const uint16x8_t lo = vmovl_u8(vget_low_u8(mask)), hi = vmovl_u8(vget_high_u8(mask));
+        const uint32x4_t alphas[4] = {
+            vmovl_u16(vget_low_u16(lo)), vmovl_u16(vget_high_u16(lo)), vmovl_u16(vget_low_u16(hi)), vmovl_u16(vget_high_u16(hi))};
+        for (unsigned i = 0; i < arraysz(alphas); i++) {
+            pixel *p = d + c + 4 * i;
+            vst1q_u32(p, vorrq_u32(vmaxq_u32(vandq_u32(vld1q_u32(p), alpha), alphas[i]), color));
+        }
+    }
+    for (; c + 8 <= width; c += 8) {
+        const uint16x8_t mask = vmovl_u8(vld1_u8(s + c));
+        const uint32x4_t alphas[2] = {vmovl_u16(vget_low_u16(mask)), vmovl_u16(vget_high_u16(mask))};
+        for (unsigned i = 0; i < arraysz(alphas); i++) {
+            pixel *p = d + c + 4 * i;
+            vst1q_u32(p, vorrq_u32(vmaxq_u32(vandq_u32(vld1q_u32(p), alpha), alphas[i]), color));
+        }
+    }
+    blend_alpha_mask_row_scalar(d + c, s + c, width - c);
+}
+#endif
+
+// Listed from worst to best
+static const struct {
+    const char *name;
+    blend_alpha_mask_row_func func;
+} alpha_mask_kernels[] = {
+    {"scalar", blend_alpha_mask_row_scalar},
+#ifdef HAS_SSE2_ALPHA_MASK_KERNEL
+    {"sse2", blend_alpha_mask_row_sse2},
+#endif
+#ifdef HAS_AVX2_ALPHA_MASK_KERNEL
+    {"avx2", blend_alpha_mask_row_avx2},
+#endif
+#ifdef HAS_NEON_ALPHA_MASK_KERNEL
+    {"neon", blend_alpha_mask_row_neon},
+#endif
+};
+
+static bool
+alpha_mask_kernel_is_supported(const char *name) {
+#ifdef HAS_AVX2_ALPHA_MASK_KERNEL
+    if (strcmp(name, "avx2") == 0) return __builtin_cpu_supports("avx2");
+#endif
+    (void)name;
+    return true;
+}
+
+// The best kernel this CPU supports
+static blend_alpha_mask_row_func blend_alpha_mask_row = blend_alpha_mask_row_scalar;
+
+static void
+select_alpha_mask_kernel(void) {
+    for (size_t i = 0; i < arraysz(alpha_mask_kernels); i++) {
+        if (alpha_mask_kernel_is_supported(alpha_mask_kernels[i].name)) blend_alpha_mask_row = alpha_mask_kernels[i].func;
+    }
+}
+
+static void
+render_alpha_mask_with(blend_alpha_mask_row_func blend_row, const uint8_t *alpha_mask, pixel* dest, const Region *src_rect, const Region *dest_rect, size_t src_stride, size_t dest_stride) {
+    // Clip once up front so that the kernels work on whole rows
+    if (src_rect->left >= src_rect->right || dest_rect->left >= dest_rect->right) return;
+    if (src_rect->top >= src_rect->bottom || dest_rect->top >= dest_rect->bottom) return;
+    const size_t width = MIN(src_rect->right - src_rect->left, dest_rect->right - dest_rect->left);
+    const size_t height = MIN(src_rect->bottom - src_rect->top, dest_rect->bottom - dest_rect->top);
+    for (size_t r = 0; r < height; r++) {
+        blend_row(dest + dest_stride * (dest_rect->top + r) + dest_rect->left, alpha_mask + src_stride * (src_rect->top + r) + src_rect->left, width);
+    }
+}
+
+void
+render_alpha_mask(const uint8_t *alpha_mask, pixel* dest, Region *src_rect, Region *dest_rect, size_t src_stride, size_t dest_stride) {
+    render_alpha_mask_with(blend_alpha_mask_row, alpha_mask, dest, src_rect, dest_rect, src_stride, dest_stride);
+}
+// }}}
 
 static void
 render_box_cell(FontGroup *fg, CPUCell *cpu_cell, GPUCell *gpu_cell) {
@@ -1512,6 +1680,42 @@ get_fallback_font(PyObject UNUSED *self, PyObject *args) {
     return fg->fonts[ans].face;
 }
 
+static PyObject*
+supported_alpha_mask_kernels(PyObject UNUSED *self, PyObject UNUSED *args) {
+    RAII_PyObject(ans, PyList_New(0));
+    if (!ans) return NULL;
+    for (size_t i = 0; i < arraysz(alpha_mask_kernels); i++) {
+        if (!alpha_mask_kernel_is_supported(alpha_mask_kernels[i].name)) continue;
+        RAII_PyObject(name, PyUnicode_FromString(alpha_mask_kernels[i].name));
+        if (!name || PyList_Append(ans, name) != 0) return NULL;
+    }
+    return PyList_AsTuple(ans);
+}
+
+static PyObject*
+test_render_alpha_mask(PyObject UNUSED *self, PyObject *args) {
+    const char *kernel; Py_buffer mask, dest; Region src_rect, dest_rect; unsigned long src_stride, dest_stride, repeat = 1;
+    if (!PyArg_ParseTuple(args, "sy*w*(IIII)(IIII)kk|k", &kernel, &mask, &dest,
+                &src_rect.left, &src_rect.top, &src_rect.right, &src_rect.bottom,
+                &dest_rect.left, &dest_rect.top, &dest_rect.right, &dest_rect.bottom, &src_stride, &dest_stride, &repeat)) return NULL;
+    PyObject *ans = NULL;
+    blend_alpha_mask_row_func blend_row = NULL;
+    for (size_t i = 0; i < arraysz(alpha_mask_kernels); i++) {
+        if (strcmp(alpha_mask_kernels[i].name, kernel) == 0 && alpha_mask_kernel_is_supported(kernel)) blend_row = alpha_mask_kernels[i].func;
+    }
+    if (!blend_row) { PyErr_Format(PyExc_KeyError, "The alpha mask kernel %s is not supported", kernel); goto end; }
+    const Region src_clip = {.right = MIN(src_rect.right, src_stride), .bottom = MIN(src_rect.bottom, src_stride ? mask.len / src_stride : 0)};
+    const Region dest_clip = {.right = MIN(dest_rect.right, dest_stride), .bottom = MIN(dest_rect.bottom, dest_stride ? dest.len / sizeof(pixel) / dest_stride : 0)};
+    if (src_rect.right > src_clip.right || src_rect.bottom > src_clip.bottom || dest_rect.right > dest_clip.right || dest_rect.bottom > dest_clip.bottom) {
+        PyErr_SetString(PyExc_IndexError, "The rectangles do not fit in the buffers"); goto end;
+    }
+    for (unsigned long i = 0; i < repeat; i++) render_alpha_mask_with(blend_row, mask.buf, dest.buf, &src_rect, &dest_rect, src_stride, dest_stride);
+    ans = Py_None; Py_INCREF(ans);
+end:
+    PyBuffer_Release(&mask); PyBuffer_Release(&dest);
+    return ans;
+}
+
 static PyObject*
 free_font_data(PyObject *self UNUSED, PyObject *args UNUSED) {
     finalize();
@@ -1523,6 +1727,8 @@ static PyMethodDef module_methods[] = {
     METHODB(free_font_data, METH_NOARGS),
     METHODB(sprite_map_set_layout, METH_VARARGS),
     METHODB(test_sprite_position_for, METH_VARARGS),
+    METHODB(supported_alpha_mask_kernels, METH_NOARGS),
+    METHODB(test_render_alpha_mask, METH_VARARGS),
     METHODB(concat_cells, METH_VARARGS),
     METHODB(set_send_sprite_to_gpu, METH_O),
     METHODB(current_fonts, METH_NOARGS),
@@ -1544,5 +1750,6 @@ init_fonts(PyObject *module) {
 #undef create_feature
     if (PyModule_AddFunctions(module, module_methods) != 0) return false;
     current_send_sprite_to_gpu = send_sprite_to_gpu;
+    select_alpha_mask_kernel();
     return true;
 }
@@ -35,6 +35,8 @@ bool face_equals_descriptor(PyObject *face_, PyObject *descriptor);
 const char* postscript_name_for_face(const PyObject*);
 
 void sprite_tracker_current_layout(FONTS_DATA_HANDLE data, unsigned int *x, unsigned int *y, unsigned int *z);
+bool sprite_tracker_texture_size(FONTS_DATA_HANDLE data, unsigned int *ynum, unsigned int *num_layers);
+bool sprite_texture_size_for_growth(unsigned int used_ynum, unsigned int used_layers, unsigned int max_ynum, unsigned int max_layers, unsigned int *ynum, unsigned int *num_layers);
 void render_alpha_mask(const uint8_t *alpha_mask, pixel* dest, Region *src_rect, Region *dest_rect, size_t src_stride, size_t dest_stride);
 void render_line(FONTS_DATA_HANDLE, Line *line, Cursor *cursor);
 void sprite_tracker_set_limits(size_t max_texture_size, size_t max_array_len);
@@ -551,16 +551,21 @@ render_color_bitmap(Face *self, int glyph_id, ProcessedBitmap *ans, unsigned int
 
 static void
 copy_color_bitmap(uint8_t *src, pixel* dest, Region *src_rect, Region *dest_rect, size_t src_stride, size_t dest_stride) {
-    for (size_t sr = src_rect->top, dr = dest_rect->top; sr < src_rect->bottom && dr < dest_rect->bottom; sr++, dr++) {
-        pixel *d = dest + dest_stride * dr;
-        uint8_t *s = src + src_stride * sr;
-        for(size_t sc = src_rect->left, dc = dest_rect->left; sc < src_rect->right && dc < dest_rect->right; sc++, dc++) {
-            uint8_t *bgra = s + 4 * sc;
+    // Clip once up front, as render_alpha_mask() does, instead of checking both rectangles for every pixel
+    if (src_rect->left >= src_rect->right || dest_rect->left >= dest_rect->right) return;
+    if (src_rect->top >= src_rect->bottom || dest_rect->top >= dest_rect->bottom) return;
+    const size_t width = MIN(src_rect->right - src_rect->left, dest_rect->right - dest_rect->left);
+    const size_t height = MIN(src_rect->bottom - src_rect->top, dest_rect->bottom - dest_rect->top);
+    for (size_t r = 0; r < height; r++) {
+        pixel *restrict d = dest + dest_stride * (dest_rect->top + r) + dest_rect->left;
+        const uint8_t *restrict s = src + src_stride * (src_rect->top + r) + 4 * src_rect->left;
+        for (size_t c = 0; c < width; c++) {
+            const uint8_t *bgra = s + 4 * c;
             if (bgra[3]) {
 #define C(idx, shift) ( (uint8_t)(((float)bgra[idx] / (float)bgra[3]) * 255) << shift)
-                d[dc] = C(2, 24) | C(1, 16) | C(0, 8) | bgra[3];
+                d[c] = C(2, 24) | C(1, 16) | C(0, 8) | bgra[3];
 #undef C
-        } else d[dc] = 0;
+            } else d[c] = 0;
         }
     }
 }
@@ -344,6 +344,9 @@ load_glfw(const char* path) {
     *(void **) (&glfwGetClipboard_impl) = dlsym(handle, "glfwGetClipboard");
     if (glfwGetClipboard_impl == NULL) fail("Failed to load glfw function glfwGetClipboard with error: %s", dlerror());
 
+    *(void **) (&glfwGetClipboardAsync_impl) = dlsym(handle, "glfwGetClipboardAsync");
+    if (glfwGetClipboardAsync_impl == NULL) fail("Failed to load glfw function glfwGetClipboardAsync with error: %s", dlerror());
+
     *(void **) (&glfwGetTime_impl) = dlsym(handle, "glfwGetTime");
     if (glfwGetTime_impl == NULL) fail("Failed to load glfw function glfwGetTime with error: %s", dlerror());
 
@@ -1395,6 +1395,7 @@ typedef enum {
 } GLFWClipboardType;
 typedef GLFWDataChunk (* GLFWclipboarditerfun)(const char *mime_type, void *iter, GLFWClipboardType ctype);
 typedef bool (* GLFWclipboardwritedatafun)(void *object, const char *data, size_t sz);
+typedef void (* GLFWclipboarddonefun)(void *object, bool ok);
 typedef bool (* GLFWimecursorpositionfun)(GLFWwindow *window, GLFWIMEUpdateEvent *ev);
 
 /*! @brief Video mode type.
@@ -1969,6 +1970,10 @@ typedef void (*glfwGetClipboard_func)(GLFWClipboardType, const char*, GLFWclipbo
 GFW_EXTERN glfwGetClipboard_func glfwGetClipboard_impl;
 #define glfwGetClipboard glfwGetClipboard_impl
 
+typedef void (*glfwGetClipboardAsync_func)(GLFWClipboardType, const char*, GLFWclipboardwritedatafun, GLFWclipboarddonefun, void*);
+GFW_EXTERN glfwGetClipboardAsync_func glfwGetClipboardAsync_impl;
+#define glfwGetClipboardAsync glfwGetClipboardAsync_impl
+
 typedef monotonic_t (*glfwGetTime_func)(void);
 GFW_EXTERN glfwGetTime_func glfwGetTime_impl;
 #define glfwGetTime glfwGetTime_impl
@@ -2009,6 +2009,49 @@ get_clipboard_mime(PyObject *self UNUSED, PyObject *args) {
     Py_RETURN_NONE;
 }
 
+typedef struct {
+    PyObject *output, *on_done;
+    bool is_self_offer;
+} AsyncClipboardRead;
+
+static bool
+write_clipboard_data_async(void *x, const char *data, size_t sz) {
+    AsyncClipboardRead *r = x;
+    Py_ssize_t z = sz;
+    if (data == NULL) {
+        r->is_self_offer = true;
+        return false;
+    }
+    PyObject *ret = PyObject_CallFunction(r->output, "y#", data, z);
+    if (ret == NULL) { PyErr_Print(); return false; }
+    Py_DECREF(ret);
+    return true;
+}
+
+static void
+clipboard_read_done(void *x, bool ok) {
+    AsyncClipboardRead *r = x;
+    PyObject *ret = PyObject_CallFunction(r->on_done, "OO", ok ? Py_True : Py_False, r->is_self_offer ? Py_True : Py_False);
+    if (ret == NULL) PyErr_Print();
+    else Py_DECREF(ret);
+    Py_DECREF(r->output); Py_DECREF(r->on_done);
+    free(r);
+}
+
+static PyObject*
+get_clipboard_mime_async(PyObject *self UNUSED, PyObject *args) {
+    int ctype;
+    const char *mime;
+    PyObject *output, *on_done;
+    if (!PyArg_ParseTuple(args, "izOO", &ctype, &mime, &output, &on_done)) return NULL;
+    AsyncClipboardRead *r = calloc(1, sizeof(AsyncClipboardRead));
+    if (!r) return PyErr_NoMemory();
+    r->output = output; r->on_done = on_done;
+    Py_INCREF(output); Py_INCREF(on_done);
+    glfwGetClipboardAsync(ctype, mime, write_clipboard_data_async, clipboard_read_done, r);
+    Py_RETURN_NONE;
+}
+
 static PyObject*
 make_x11_window_a_dock_window(PyObject *self UNUSED, PyObject *args UNUSED) {
     int x11_window_id;
@@ -2034,6 +2077,7 @@ static PyMethodDef module_methods[] = {
     METHODB(set_default_window_icon, METH_VARARGS),
     METHODB(set_clipboard_data_types, METH_VARARGS),
     METHODB(get_clipboard_mime, METH_VARARGS),
+    METHODB(get_clipboard_mime_async, METH_VARARGS),
     METHODB(toggle_secure_input, METH_NOARGS),
     METHODB(get_content_scale_for_window, METH_NOARGS),
     METHODB(toggle_fullscreen, METH_VARARGS),
@@ -10,27 +10,191 @@
 #include "charsets.h"
 #include <structmember.h>
 #include "ringbuf.h"
+#include <sys/mman.h>
+#include <unistd.h>
 
 extern PyTypeObject Line_Type;
 #define SEGMENT_SIZE 2048
 
+// Deduplicated line storage {{{
+// When deduplication is enabled segments store references to refcounted line
+// payloads. Identical lines added to history share a single payload, found via
+// a global hash table. Payloads that are about to be written to directly, for
+// example when rewrapping, are first made private to the line that owns them.
+
+struct HistoryLine {
+    HistoryLine *next;
+    uint64_t hash;
+    index_type xnum;
+    unsigned int refcount;
+    bool in_pool;
+    GPUCell *gpu_cells;
+    CPUCell *cpu_cells;
+};
+
+static struct {
+    HistoryLine **buckets;
+    size_t num_buckets, count;
+    size_t num_payloads, payload_bytes;
+} line_pool = {0};
+
+static size_t
+history_line_size(index_type xnum) { return sizeof(HistoryLine) + xnum * (sizeof(GPUCell) + sizeof(CPUCell)); }
+
+static HistoryLine*
+alloc_history_line(index_type xnum) {
+    HistoryLine *ans = calloc(1, history_line_size(xnum));
+    if (!ans) fatal("Out of memory allocating history line");
+    ans->xnum = xnum; ans->refcount = 1;
+    ans->gpu_cells = (GPUCell*)(ans + 1);
+    ans->cpu_cells = (CPUCell*)(ans->gpu_cells + xnum);
+    line_pool.num_payloads++; line_pool.payload_bytes += history_line_size(xnum);
+    return ans;
+}
+
+static uint64_t
+hash_bytes(uint64_t h, const void *data, size_t sz) {
+    const uint8_t *p = data;
+    uint64_t w;
+    for (; sz >= sizeof(w); sz -= sizeof(w), p += sizeof(w)) {
+        memcpy(&w, p, sizeof(w));
+        h = (h ^ w) * 0x100000001b3ull;
+        h ^= h >> 29;
+    }
+    for (; sz; sz--, p++) h = (h ^ *p) * 0x100000001b3ull;
+    return h;
+}
+
+static uint64_t
+hash_line(const Line *line, index_type xnum) {
+    uint64_t h = 0xcbf29ce484222325ull ^ xnum;
+    h = hash_bytes(h, line->gpu_cells, xnum * sizeof(GPUCell));
+    return hash_bytes(h, line->cpu_cells, xnum * sizeof(CPUCell));
+}
+
+static void
+pool_remove(HistoryLine *l) {
+    HistoryLine **q = line_pool.buckets + (l->hash & (line_pool.num_buckets - 1));
+    while (*q && *q != l) q = &(*q)->next;
+    if (*q) { *q = l->next; line_pool.count--; }
+    l->next = NULL; l->in_pool = false;
+}
+
+static void
+pool_add(HistoryLine *l) {
+    if (line_pool.count >= line_pool.num_buckets) {
+        size_t num = MAX(1024u, line_pool.num_buckets * 2);
+        HistoryLine **buckets = calloc(num, sizeof(buckets[0]));
+        if (!buckets) return;  // no deduplication for this line
+        for (size_t i = 0; i < line_pool.num_buckets; i++) {
+            for (HistoryLine *x = line_pool.buckets[i], *next; x; x = next) {
+                next = x->next;
+                HistoryLine **b = buckets + (x->hash & (num - 1));
+                x->next = *b; *b = x;
+            }
+        }
+        free(line_pool.buckets);
+        line_pool.buckets = buckets; line_pool.num_buckets = num;
+    }
+    HistoryLine **b = line_pool.buckets + (l->hash & (line_pool.num_buckets - 1));
+    l->next = *b; *b = l; l->in_pool = true;
+    line_pool.count++;
+}
+
+static HistoryLine*
+pool_find(uint64_t hash, const Line *line, index_type xnum) {
+    if (!line_pool.num_buckets) return NULL;
+    for (HistoryLine *l = line_pool.buckets[hash & (line_pool.num_buckets - 1)]; l; l = l->next) {
+        if (l->hash == hash && l->xnum == xnum &&
+                memcmp(l->gpu_cells, line->gpu_cells, xnum * sizeof(GPUCell)) == 0 &&
+                memcmp(l->cpu_cells, line->cpu_cells, xnum * sizeof(CPUCell)) == 0) return l;
+    }
+    return NULL;
+}
+
+static void
+release_history_line(HistoryLine *l) {
+    if (!l || --l->refcount) return;
+    if (l->in_pool) pool_remove(l);
+    line_pool.num_payloads--; line_pool.payload_bytes -= history_line_size(l->xnum);
+    free(l);
+}
+// }}}
+
+// Segment storage {{{
+// Cell storage for segments is mmapped directly so that pages are only committed
+// when lines are first written to and are returned to the OS when the
+// history is cleared, rather than lingering in the malloc heap.
+
+static void*
+alloc_segment_storage(size_t sz) {
+    void *ans = mmap(NULL, sz, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ans == MAP_FAILED) fatal("Out of memory allocating new history buffer segment");
+    return ans;
+}
+
+static void
+release_segment_pages(HistoryBufSegment *s) {
+    // Contents are undefined afterwards, only lines that are re-initialized before use may be stored here
+    if (!s->storage_sz) return;
+#ifdef __APPLE__
+    madvise(s->cpu_cells, s->storage_sz, MADV_FREE);
+#else
+    madvise(s->cpu_cells, s->storage_sz, MADV_DONTNEED);
+#endif
+}
+
+static size_t
+resident_bytes(void *addr, size_t sz) {
+    static size_t page_size = 0;
+    if (!page_size) page_size = sysconf(_SC_PAGESIZE);
+    if (!sz || !page_size) return 0;
+    const size_t num_pages = (sz + page_size - 1) / page_size;
+#ifdef __APPLE__
+    char *vec = malloc(num_pages);
+#else
+    unsigned char *vec = malloc(num_pages);
+#endif
+    if (!vec) return 0;
+    size_t ans = 0;
+    if (mincore(addr, sz, vec) == 0) {
+        for (size_t i = 0; i < num_pages; i++) if (vec[i] & 1) ans += page_size;
+    }
+    free(vec);
+    return ans;
+}
+// }}}
+
 static void
 add_segment(HistoryBuf *self) {
     self->num_segments += 1;
     self->segments = realloc(self->segments, sizeof(HistoryBufSegment) * self->num_segments);
     if (self->segments == NULL) fatal("Out of memory allocating new history buffer segment");
     HistoryBufSegment *s = self->segments + self->num_segments - 1;
+    if (self->deduplicate) {
+        s->lines = calloc(1, SEGMENT_SIZE * (sizeof(HistoryLine*) + sizeof(LineAttrs)));
+        if (!s->lines) fatal("Out of memory allocating new history buffer segment");
+        s->line_attrs = (LineAttrs*)(s->lines + SEGMENT_SIZE);
+        s->cpu_cells = NULL; s->gpu_cells = NULL; s->storage_sz = 0;
+        return;
+    }
+    s->lines = NULL;
     const size_t cpu_cells_size = self->xnum * SEGMENT_SIZE * sizeof(CPUCell);
     const size_t gpu_cells_size = self->xnum * SEGMENT_SIZE * sizeof(GPUCell);
-    s->cpu_cells = calloc(1, cpu_cells_size + gpu_cells_size + SEGMENT_SIZE * sizeof(LineAttrs));
-    if (!s->cpu_cells) fatal("Out of memory allocating new history buffer segment");
+    s->storage_sz = cpu_cells_size + gpu_cells_size + SEGMENT_SIZE * sizeof(LineAttrs);
+    s->cpu_cells = alloc_segment_storage(s->storage_sz);
     s->gpu_cells = (GPUCell*)(((uint8_t*)s->cpu_cells) + cpu_cells_size);
     s->line_attrs = (LineAttrs*)(((uint8_t*)s->gpu_cells) + gpu_cells_size);
 }
 
 static void
 free_segment(HistoryBufSegment *s) {
-    free(s->cpu_cells); memset(s, 0, sizeof(HistoryBufSegment));
+    if (s->lines) {
+        for (index_type i = 0; i < SEGMENT_SIZE; i++) release_history_line(s->lines[i]);
+        free(s->lines);
+    }
+    if (s->storage_sz) munmap(s->cpu_cells, s->storage_sz);
+    memset(s, 0, sizeof(HistoryBufSegment));
 }
 
 static index_type
@@ -47,13 +211,61 @@ segment_for(HistoryBuf *self, index_type y) {
     return self->segments[seg_num].which + y * stride; \
 }
 
+static HistoryLine**
+line_slot(HistoryBuf *self, index_type y) {
+    seg_ptr(lines, 1);
+}
+
+static HistoryLine*
+history_line(HistoryBuf *self, index_type y) {
+    HistoryLine **slot = line_slot(self, y);
+    if (UNLIKELY(!*slot)) *slot = alloc_history_line(self->xnum);
+    return *slot;
+}
+
+static HistoryLine*
+make_line_private(HistoryBuf *self, index_type y, bool copy_contents) {
+    // Ensure the payload of line y is not shared, so that it can be written to
+    HistoryLine **slot = line_slot(self, y), *l = *slot;
+    if (l && l->refcount == 1) {
+        if (l->in_pool) pool_remove(l);
+        return l;
+    }
+    HistoryLine *ans = alloc_history_line(self->xnum);
+    if (l && copy_contents) memcpy(ans->gpu_cells, l->gpu_cells, history_line_size(self->xnum) - sizeof(HistoryLine));
+    release_history_line(l);
+    *slot = ans;
+    return ans;
+}
+
+static void
+set_shared_line(HistoryBuf *self, index_type y, const Line *line) {
+    const uint64_t hash = hash_line(line, self->xnum);
+    HistoryLine **slot = line_slot(self, y), *l = pool_find(hash, line, self->xnum);
+    if (l) {
+        if (l != *slot) {
+            l->refcount++;
+            release_history_line(*slot);
+            *slot = l;
+        }
+        return;
+    }
+    l = make_line_private(self, y, false);
+    memcpy(l->gpu_cells, line->gpu_cells, self->xnum * sizeof(GPUCell));
+    memcpy(l->cpu_cells, line->cpu_cells, self->xnum * sizeof(CPUCell));
+    l->hash = hash;
+    pool_add(l);
+}
+
 static CPUCell*
 cpu_lineptr(HistoryBuf *self, index_type y) {
+    if (self->deduplicate) return history_line(self, y)->cpu_cells;
     seg_ptr(cpu_cells, self->xnum);
 }
 
 static GPUCell*
 gpu_lineptr(HistoryBuf *self, index_type y) {
+    if (self->deduplicate) return history_line(self, y)->gpu_cells;
     seg_ptr(gpu_cells, self->xnum);
 }
 
@@ -66,6 +278,12 @@ attrptr(HistoryBuf *self, index_type y) {
 static size_t
 initial_pagerhist_ringbuf_sz(size_t pagerhist_sz) { return MIN(1024u * 1024u, pagerhist_sz); }
 
+static void
+pagerhist_reset_lines(PagerHistoryBuf *ph) {
+    ph->lines.first = 0; ph->lines.count = 1; ph->lines.num_bytes = 0;
+    ph->lines.items[0] = (PagerHistoryLine){0};
+}
+
 static PagerHistoryBuf*
 alloc_pagerhist(size_t pagerhist_sz) {
     PagerHistoryBuf *ph;
@@ -75,13 +293,20 @@ alloc_pagerhist(size_t pagerhist_sz) {
     size_t sz = initial_pagerhist_ringbuf_sz(pagerhist_sz);
     ph->ringbuf = ringbuf_new(sz);
     if (!ph->ringbuf) { free(ph); return NULL; }
+    ph->lines.capacity = 1024;
+    ph->lines.items = malloc(ph->lines.capacity * sizeof(ph->lines.items[0]));
+    if (!ph->lines.items) { ringbuf_free((ringbuf_t*)&ph->ringbuf); free(ph); return NULL; }
+    pagerhist_reset_lines(ph);
     ph->maximum_size = pagerhist_sz;
     return ph;
 }
 
 static void
 free_pagerhist(HistoryBuf *self) {
-    if (self->pagerhist && self->pagerhist->ringbuf) ringbuf_free((ringbuf_t*)&self->pagerhist->ringbuf);
+    if (self->pagerhist) {
+        if (self->pagerhist->ringbuf) ringbuf_free((ringbuf_t*)&self->pagerhist->ringbuf);
+        free(self->pagerhist->lines.items);
+    }
     free(self->pagerhist);
     self->pagerhist = NULL;
 }
@@ -110,11 +335,12 @@ pagerhist_clear(HistoryBuf *self) {
             ringbuf_free((ringbuf_t*)&self->pagerhist->ringbuf);
             self->pagerhist->ringbuf = rbuf;
         }
+        pagerhist_reset_lines(self->pagerhist);
     }
 }
 
 static HistoryBuf*
-create_historybuf(PyTypeObject *type, unsigned int xnum, unsigned int ynum, unsigned int pagerhist_sz) {
+create_historybuf(PyTypeObject *type, unsigned int xnum, unsigned int ynum, unsigned int pagerhist_sz, bool deduplicate) {
     if (xnum == 0 || ynum == 0) {
         PyErr_SetString(PyExc_ValueError, "Cannot create an empty history buffer");
         return NULL;
@@ -123,6 +349,7 @@ create_historybuf(PyTypeObject *type, unsigned int xnum, unsigned int ynum, unsi
     if (self != NULL) {
         self->xnum = xnum;
         self->ynum = ynum;
+        self->deduplicate = deduplicate;
         self->num_segments = 0;
         add_segment(self);
         self->line = alloc_line();
@@ -135,8 +362,9 @@ create_historybuf(PyTypeObject *type, unsigned int xnum, unsigned int ynum, unsi
 static PyObject *
 new(PyTypeObject *type, PyObject *args, PyObject UNUSED *kwds) {
     unsigned int xnum = 1, ynum = 1, pagerhist_sz = 0;
-    if (!PyArg_ParseTuple(args, "II|I", &ynum, &xnum, &pagerhist_sz)) return NULL;
-    HistoryBuf *ans = create_historybuf(type, xnum, ynum, pagerhist_sz);
+    int deduplicate = 0;
+    if (!PyArg_ParseTuple(args, "II|Ip", &ynum, &xnum, &pagerhist_sz, &deduplicate)) return NULL;
+    HistoryBuf *ans = create_historybuf(type, xnum, ynum, pagerhist_sz, deduplicate);
     return (PyObject*)ans;
 }
 
@@ -191,6 +419,38 @@ historybuf_cpu_cells(HistoryBuf *self, index_type lnum) {
     return cpu_lineptr(self, index_of(self, lnum));
 }
 
+void
+historybuf_init_line_for_rendering(HistoryBuf *self, index_type lnum, Line *l) {
+    // Rendering and marking write per window state into the cells, so they
+    // must not go into a payload shared with other lines or windows. The line
+    // is shared again by historybuf_finish_rendering_line().
+    const index_type num = index_of(self, lnum);
+    if (self->deduplicate) make_line_private(self, num, true);
+    init_line(self, num, l);
+}
+
+void
+historybuf_finish_rendering_line(HistoryBuf *self, index_type lnum, Line *l) {
+    const index_type num = index_of(self, lnum);
+    attrptr(self, num)->has_dirty_text = false;
+    if (!self->deduplicate) return;
+    // Identical lines rendered with the same fonts and marker have identical
+    // cells, so they can share a payload again
+    HistoryLine **slot = line_slot(self, num), *p = *slot;
+    const Line rendered = {.cpu_cells = p->cpu_cells, .gpu_cells = p->gpu_cells};
+    const uint64_t hash = hash_line(&rendered, self->xnum);
+    HistoryLine *shared = pool_find(hash, &rendered, self->xnum);
+    if (shared) {
+        shared->refcount++;
+        release_history_line(p);
+        *slot = shared;
+        init_line(self, num, l);
+    } else {
+        p->hash = hash;
+        pool_add(p);
+    }
+}
+
 void
 historybuf_mark_line_clean(HistoryBuf *self, index_type y) {
     attrptr(self, index_of(self, y))->has_dirty_text = false;
@@ -208,15 +468,87 @@ historybuf_clear(HistoryBuf *self) {
     self->start_of_data = 0;
     for (size_t i = 1; i < self->num_segments; i++) free_segment(self->segments + i);
     self->num_segments = 1;
+    if (self->segments[0].lines) {
+        for (index_type i = 0; i < SEGMENT_SIZE; i++) { release_history_line(self->segments[0].lines[i]); self->segments[0].lines[i] = NULL; }
+    }
+    release_segment_pages(self->segments);
+}
+
+static PagerHistoryLine*
+pagerhist_current_line(PagerHistoryBuf *ph) {
+    return ph->lines.items + ph->lines.first + ph->lines.count - 1;
+}
+
+static void
+pagerhist_add_cells(PagerHistoryLine *l, index_type cells) {
+    l->max_cells = cells > UINT_MAX - l->max_cells ? UINT_MAX : l->max_cells + cells;
+}
+
+static bool
+pagerhist_start_line(PagerHistoryBuf *ph) {
+    if (ph->lines.first + ph->lines.count >= ph->lines.capacity) {
+        if (ph->lines.first >= ph->lines.count) {
+            memmove(ph->lines.items, ph->lines.items + ph->lines.first, ph->lines.count * sizeof(ph->lines.items[0]));
+            ph->lines.first = 0;
+        } else {
+            size_t newcap = ph->lines.capacity * 2;
+            PagerHistoryLine *items = realloc(ph->lines.items, newcap * sizeof(ph->lines.items[0]));
+            if (!items) return false;
+            ph->lines.items = items; ph->lines.capacity = newcap;
+        }
+    }
+    ph->lines.items[ph->lines.first + ph->lines.count++] = (PagerHistoryLine){0};
+    return true;
+}
+
+static void
+pagerhist_index_bytes(PagerHistoryBuf *ph, const uint8_t *buf, size_t sz, index_type cells) {
+    const uint8_t *end = buf + sz, *p;
+    ph->lines.num_bytes += sz;
+    pagerhist_add_cells(pagerhist_current_line(ph), cells);
+    while ((p = memchr(buf, '\n', end - buf))) {
+        p++;
+        pagerhist_current_line(ph)->num_bytes += p - buf;
+        buf = p;
+        if (!pagerhist_start_line(ph)) {
+            // out of memory, keep going with the newline as part of the current line, it
+            // will be handled when wrapping
+            pagerhist_current_line(ph)->max_cells = UINT_MAX;
+            continue;
+        }
+        pagerhist_add_cells(pagerhist_current_line(ph), cells);
+    }
+    pagerhist_current_line(ph)->num_bytes += end - buf;
+}
+
+static void
+pagerhist_trim_index(PagerHistoryBuf *ph) {
+    // drop lines from the index whose bytes have been evicted from the ringbuf
+    const size_t used = ringbuf_bytes_used(ph->ringbuf);
+    while (ph->lines.num_bytes > used) {
+        size_t excess = ph->lines.num_bytes - used;
+        PagerHistoryLine *l = ph->lines.items + ph->lines.first;
+        if (l->num_bytes <= excess && ph->lines.count > 1) {
+            ph->lines.num_bytes -= l->num_bytes;
+            ph->lines.first++; ph->lines.count--;
+        } else {
+            excess = MIN(excess, l->num_bytes);
+            l->num_bytes -= excess;
+            ph->lines.num_bytes -= excess;
+            if (!excess) break;
+        }
+    }
 }
 
 static bool
-pagerhist_write_bytes(PagerHistoryBuf *ph, const uint8_t *buf, size_t sz) {
+pagerhist_write_bytes(PagerHistoryBuf *ph, const uint8_t *buf, size_t sz, index_type cells) {
     if (sz > ph->maximum_size) return false;
     if (!sz) return true;
     size_t space_in_ringbuf = ringbuf_bytes_free(ph->ringbuf);
     if (sz > space_in_ringbuf) pagerhist_extend(ph, sz);
     ringbuf_memcpy_into(ph->ringbuf, buf, sz);
+    pagerhist_index_bytes(ph, buf, sz, cells);
+    if (sz > space_in_ringbuf) pagerhist_trim_index(ph);
     return true;
 }
 
@@ -235,19 +567,24 @@ pagerhist_ensure_start_is_valid_utf8(PagerHistoryBuf *ph) {
     }
     if (last_reject_at) {
         ringbuf_memmove_from(scratch, ph->ringbuf, last_reject_at);
+        pagerhist_trim_index(ph);
         return true;
     }
     return false;
 }
 
 static bool
-pagerhist_write_ucs4(PagerHistoryBuf *ph, const Py_UCS4 *buf, size_t sz) {
-    uint8_t scratch[4];
+pagerhist_write_ucs4(PagerHistoryBuf *ph, const Py_UCS4 *buf, size_t sz, index_type cells) {
+    uint8_t scratch[4096];
+    size_t num = 0;
     for (size_t i = 0; i < sz; i++) {
-        unsigned int num = encode_utf8(buf[i], (char*)scratch);
-        if (!pagerhist_write_bytes(ph, scratch, num)) return false;
+        if (num > sizeof(scratch) - 4) {
+            if (!pagerhist_write_bytes(ph, scratch, num, cells)) return false;
+            num = 0;
+        }
+        num += encode_utf8(buf[i], (char*)scratch + num);
     }
-    return true;
+    return pagerhist_write_bytes(ph, scratch, num, cells);
 }
 
 static void
@@ -258,19 +595,17 @@ pagerhist_push(HistoryBuf *self, ANSIBuf *as_ansi_buf) {
     Line l = {.xnum=self->xnum};
     init_line(self, self->start_of_data, &l);
     line_as_ansi(&l, as_ansi_buf, &prev_cell, 0, l.xnum, 0);
-    pagerhist_write_bytes(ph, (const uint8_t*)"\x1b[m", 3);
-    if (pagerhist_write_ucs4(ph, as_ansi_buf->buf, as_ansi_buf->len)) {
-        char line_end[2]; size_t num = 0;
-        line_end[num++] = '\r';
-        if (!l.gpu_cells[l.xnum - 1].attrs.next_char_was_wrapped) line_end[num++] = '\n';
-        pagerhist_write_bytes(ph, (const uint8_t*)line_end, num);
+    // Lines are stored unwrapped, wrap markers are added when exporting
+    pagerhist_write_bytes(ph, (const uint8_t*)"\x1b[m", 3, 0);
+    if (pagerhist_write_ucs4(ph, as_ansi_buf->buf, as_ansi_buf->len, 0)) {
+        pagerhist_add_cells(pagerhist_current_line(ph), l.xnum);
+        if (!l.gpu_cells[l.xnum - 1].attrs.next_char_was_wrapped) pagerhist_write_bytes(ph, (const uint8_t*)"\n", 1, 0);
     }
 }
 
 static index_type
-historybuf_push(HistoryBuf *self, ANSIBuf *as_ansi_buf) {
+historybuf_advance(HistoryBuf *self, ANSIBuf *as_ansi_buf) {
     index_type idx = (self->start_of_data + self->count) % self->ynum;
-    init_line(self, idx, self->line);
     if (self->count == self->ynum) {
         pagerhist_push(self, as_ansi_buf);
         self->start_of_data = (self->start_of_data + 1) % self->ynum;
@@ -278,8 +613,23 @@ historybuf_push(HistoryBuf *self, ANSIBuf *as_ansi_buf) {
     return idx;
 }
 
+static index_type
+historybuf_push(HistoryBuf *self, ANSIBuf *as_ansi_buf) {
+    // The returned line is available for writing via self->line
+    index_type idx = historybuf_advance(self, as_ansi_buf);
+    if (self->deduplicate) make_line_private(self, idx, false);
+    init_line(self, idx, self->line);
+    return idx;
+}
+
 void
 historybuf_add_line(HistoryBuf *self, const Line *line, ANSIBuf *as_ansi_buf) {
+    if (self->deduplicate && line->xnum == self->xnum) {
+        index_type idx = historybuf_advance(self, as_ansi_buf);
+        set_shared_line(self, idx, line);
+        *attrptr(self, idx) = line->attrs;
+        return;
+    }
     index_type idx = historybuf_push(self, as_ansi_buf);
     copy_line(line, self->line);
     *attrptr(self, idx) = line->attrs;
@@ -297,7 +647,9 @@ historybuf_pop_line(HistoryBuf *self, Line *line) {
 static void
 history_buf_set_last_char_as_continuation(HistoryBuf *self, index_type y, bool wrapped) {
     if (self->count > 0) {
-        gpu_lineptr(self, index_of(self, y))[self->xnum-1].attrs.next_char_was_wrapped = wrapped;
+        const index_type idx = index_of(self, y);
+        if (self->deduplicate && gpu_lineptr(self, idx)[self->xnum-1].attrs.next_char_was_wrapped != wrapped) make_line_private(self, idx, true);
+        gpu_lineptr(self, idx)[self->xnum-1].attrs.next_char_was_wrapped = wrapped;
     }
 }
 
@@ -342,112 +694,134 @@ push(HistoryBuf *self, PyObject *args) {
 static Line*
 get_line(HistoryBuf *self, index_type y, Line *l) { init_line(self, index_of(self, self->count - y - 1), l); return l; }
 
-static char_type
-pagerhist_remove_char(PagerHistoryBuf *ph, unsigned *count, uint8_t record[8]) {
-    uint32_t codep; UTF8State state = UTF8_ACCEPT;
-    *count = 0;
-    size_t num = ringbuf_bytes_used(ph->ringbuf);
-    while (num--) {
-        record[*count] = ringbuf_move_char(ph->ringbuf);
-        decode_utf8(&state, &codep, record[*count]);
-        *count += 1;
-        if (state == UTF8_REJECT) { codep = 0; break; }
-        if (state == UTF8_ACCEPT) break;
+static PyObject*
+pagerhist_write(HistoryBuf *self, PyObject *what) {
+    if (self->pagerhist && self->pagerhist->maximum_size) {
+        // the width of arbitrary text is not known, so it is always scanned when wrapping
+        if (PyBytes_Check(what)) pagerhist_write_bytes(self->pagerhist, (const uint8_t*)PyBytes_AS_STRING(what), PyBytes_GET_SIZE(what), UINT_MAX);
+        else if (PyUnicode_Check(what) && PyUnicode_READY(what) == 0) {
+            Py_UCS4 *buf = PyUnicode_AsUCS4Copy(what);
+            if (buf) {
+                pagerhist_write_ucs4(self->pagerhist, buf, PyUnicode_GET_LENGTH(what), UINT_MAX);
+                PyMem_Free(buf);
+            }
+        }
     }
-    return codep;
+    Py_RETURN_NONE;
 }
 
-static void
-pagerhist_rewrap_to(HistoryBuf *self, index_type cells_in_line) {
-    PagerHistoryBuf *ph = self->pagerhist;
-    if (!ph->ringbuf || !ringbuf_bytes_used(ph->ringbuf)) return;
-    PagerHistoryBuf *nph = calloc(1, sizeof(PagerHistoryBuf));
-    if (!nph) return;
-    nph->maximum_size = ph->maximum_size;
-    nph->ringbuf = ringbuf_new(MIN(ph->maximum_size, ringbuf_capacity(ph->ringbuf) + 4096));
-    if (!nph->ringbuf) { free(nph); return ; }
-    ssize_t ch_width = 0;
-    unsigned count;
-    uint8_t record[8];
+static const uint8_t*
+reverse_find(const uint8_t *haystack, size_t haystack_sz, const uint8_t *needle) {
+    const size_t needle_sz = strlen((const char*)needle);
+    if (!needle_sz || needle_sz > haystack_sz) return NULL;
+    const uint8_t *p = haystack + haystack_sz - (needle_sz - 1);
+    while (--p >= haystack) {
+        if (*p == needle[0] && memcmp(p, needle, MIN(needle_sz, haystack_sz - (p - haystack))) == 0) return p;
+    }
+    return NULL;
+}
+
+typedef struct {
+    PyObject *bytes;
+    size_t len, capacity;
+} WrapOutput;
+
+static bool
+wrap_output_write(WrapOutput *o, const uint8_t *src, size_t sz) {
+    if (o->len + sz > o->capacity) {
+        size_t newcap = MAX(o->capacity + o->capacity / 2, o->len + sz);
+        if (_PyBytes_Resize(&o->bytes, newcap) != 0) return false;
+        o->capacity = newcap;
+    }
+    memcpy(PyBytes_AS_STRING(o->bytes) + o->len, src, sz);
+    o->len += sz;
+    return true;
+}
+
+static bool
+pagerhist_wrap_line(WrapOutput *o, const uint8_t *src, size_t sz, index_type cells_in_line) {
+    // Insert wrap markers (\r) into a logical line so that it fits in cells_in_line, existing wrap markers are dropped
     index_type num_in_current_line = 0;
-    char_type ch;
+    int ch_width;
+    uint32_t codep; UTF8State state = UTF8_ACCEPT;
+    size_t char_start = 0;
     WCSState wcs_state;
     initialize_wcs_state(&wcs_state);
 
 #define WRITE_CHAR() { \
     if (num_in_current_line + ch_width > cells_in_line) { \
-        pagerhist_write_bytes(nph, (const uint8_t*)"\r", 1); \
+        if (!wrap_output_write(o, (const uint8_t*)"\r", 1)) return false; \
         num_in_current_line = 0; \
     }\
     if (ch_width >= 0 || (int)num_in_current_line >= -ch_width) num_in_current_line += ch_width; \
-    pagerhist_write_bytes(nph, record, count); \
+    if (!wrap_output_write(o, src + char_start, i + 1 - char_start)) return false; \
 }
 
-    while (ringbuf_bytes_used(ph->ringbuf)) {
-        ch = pagerhist_remove_char(ph, &count, record);
-        if (ch == '\n') {
+    for (size_t i = 0; i < sz; i++) {
+        decode_utf8(&state, &codep, src[i]);
+        if (state == UTF8_REJECT) { codep = 0; state = UTF8_ACCEPT; }
+        else if (state != UTF8_ACCEPT) continue;
+        if (codep == '\n') {
+            if (!wrap_output_write(o, (const uint8_t*)"\r\n", 2)) return false;
             initialize_wcs_state(&wcs_state);
-            ch_width = 1;
-            WRITE_CHAR();
             num_in_current_line = 0;
-        } else if (ch != '\r') {
-            ch_width = wcswidth_step(&wcs_state, ch);
+        } else if (codep != '\r') {
+            ch_width = wcswidth_step(&wcs_state, codep);
             WRITE_CHAR();
         }
+        char_start = i + 1;
     }
-    free_pagerhist(self);
-    self->pagerhist = nph;
+    return true;
 #undef WRITE_CHAR
 }
 
-static PyObject*
-pagerhist_write(HistoryBuf *self, PyObject *what) {
-    if (self->pagerhist && self->pagerhist->maximum_size) {
-        if (PyBytes_Check(what)) pagerhist_write_bytes(self->pagerhist, (const uint8_t*)PyBytes_AS_STRING(what), PyBytes_GET_SIZE(what));
-        else if (PyUnicode_Check(what) && PyUnicode_READY(what) == 0) {
-            Py_UCS4 *buf = PyUnicode_AsUCS4Copy(what);
-            if (buf) {
-                pagerhist_write_ucs4(self->pagerhist, buf, PyUnicode_GET_LENGTH(what));
-                PyMem_Free(buf);
-            }
-        }
-    }
-    Py_RETURN_NONE;
-}
-
-static const uint8_t*
-reverse_find(const uint8_t *haystack, size_t haystack_sz, const uint8_t *needle) {
-    const size_t needle_sz = strlen((const char*)needle);
-    if (!needle_sz || needle_sz > haystack_sz) return NULL;
-    const uint8_t *p = haystack + haystack_sz - (needle_sz - 1);
-    while (--p >= haystack) {
-        if (*p == needle[0] && memcmp(p, needle, MIN(needle_sz, haystack_sz - (p - haystack))) == 0) return p;
+static bool
+pagerhist_wrap_to(PagerHistoryBuf *ph, const uint8_t *src, size_t sz, index_type cells_in_line, WrapOutput *o) {
+    // Lines that are known to fit are copied as is, only the rest are scanned character by character
+    o->capacity = sz + sz / 16 + 64;
+    o->bytes = PyBytes_FromStringAndSize(NULL, o->capacity);
+    if (!o->bytes) return false;
+    for (size_t i = 0; i < ph->lines.count && sz; i++) {
+        const PagerHistoryLine *l = ph->lines.items + ph->lines.first + i;
+        size_t n = MIN(l->num_bytes, sz);
+        const bool terminated = n && src[n-1] == '\n';
+        if (l->max_cells <= cells_in_line) {
+            if (!wrap_output_write(o, src, terminated ? n - 1 : n)) return false;
+            if (terminated) { if (!wrap_output_write(o, (const uint8_t*)"\r\n", 2)) return false; }
+        } else if (!pagerhist_wrap_line(o, src, n, cells_in_line)) return false;
+        // the last line continues into the history buffer
+        if (!terminated && i + 1 == ph->lines.count && n) { if (!wrap_output_write(o, (const uint8_t*)"\r", 1)) return false; }
+        src += n; sz -= n;
     }
-    return NULL;
+    return !sz || pagerhist_wrap_line(o, src, sz, cells_in_line);
 }
 
 static PyObject*
 pagerhist_as_bytes(HistoryBuf *self, PyObject *args) {
-    int upto_output_start = 0;
-    if (!PyArg_ParseTuple(args, "|p", &upto_output_start)) return NULL;
+    int upto_output_start = 0, add_wrap_markers = 1;
+    if (!PyArg_ParseTuple(args, "|pp", &upto_output_start, &add_wrap_markers)) return NULL;
 #define ph self->pagerhist
     if (!ph || !ringbuf_bytes_used(ph->ringbuf)) return PyBytes_FromStringAndSize("", 0);
     pagerhist_ensure_start_is_valid_utf8(ph);
-    if (ph->rewrap_needed) pagerhist_rewrap_to(self, self->xnum);
 
+    // wrap directly from the ringbuf into the bytes object, so that the contents are copied only once
     size_t sz = ringbuf_bytes_used(ph->ringbuf);
-    PyObject *ans = PyBytes_FromStringAndSize(NULL, sz);
-    if (!ans) return NULL;
-    uint8_t *buf = (uint8_t*)PyBytes_AS_STRING(ans);
-    ringbuf_memcpy_from(buf, ph->ringbuf, sz);
+    const uint8_t *src = ringbuf_linearize(ph->ringbuf);
+    WrapOutput o = {0};
+    if (add_wrap_markers) {
+        if (!pagerhist_wrap_to(ph, src, sz, self->xnum, &o)) { Py_CLEAR(o.bytes); return PyErr_Occurred() ? NULL : PyErr_NoMemory(); }
+    } else {
+        o.bytes = PyBytes_FromStringAndSize((const char*)src, sz);
+        if (!o.bytes) return NULL;
+        o.len = sz;
+    }
     if (upto_output_start) {
-        const uint8_t *p = reverse_find(buf, sz, (const uint8_t*)"\x1b]133;C\x1b\\");
-        if (p) {
-            PyObject *t = PyBytes_FromStringAndSize((const char*)p, sz - (p - buf));
-            Py_DECREF(ans); ans = t;
-        }
+        uint8_t *buf = (uint8_t*)PyBytes_AS_STRING(o.bytes);
+        const uint8_t *p = reverse_find(buf, o.len, (const uint8_t*)"\x1b]133;C\x1b\\");
+        if (p) { o.len -= p - buf; memmove(buf, p, o.len); }
     }
-    return ans;
+    if ((size_t)PyBytes_GET_SIZE(o.bytes) != o.len && _PyBytes_Resize(&o.bytes, o.len) != 0) return NULL;
+    return o.bytes;
 #undef ph
 }
 
@@ -496,14 +870,31 @@ dirty_lines(HistoryBuf *self, PyObject *a UNUSED) {
 }
 
 static PyObject*
-pagerhist_rewrap(HistoryBuf *self, PyObject *xnum) {
-    if (self->pagerhist) {
-        pagerhist_rewrap_to(self, PyLong_AsUnsignedLong(xnum));
+memory_usage(HistoryBuf *self, PyObject *a UNUSED) {
+#define memory_usage_doc "memory_usage() -> Memory used by the lines in this buffer. Shared lines are attributed proportionally to their users. resident_bytes is the part of segment_bytes actually committed."
+    size_t segment_bytes = 0, resident = 0, line_bytes = 0, shared_lines = 0;
+    for (index_type i = 0; i < self->num_segments; i++) {
+        HistoryBufSegment *s = self->segments + i;
+        if (!s->lines) {
+            segment_bytes += s->storage_sz;
+            resident += resident_bytes(s->cpu_cells, s->storage_sz);
+            continue;
+        }
+        segment_bytes += SEGMENT_SIZE * (sizeof(HistoryLine*) + sizeof(LineAttrs));
+        for (index_type y = 0; y < SEGMENT_SIZE; y++) {
+            const HistoryLine *l = s->lines[y];
+            if (!l) continue;
+            line_bytes += history_line_size(l->xnum) / l->refcount;
+            if (l->refcount > 1) shared_lines++;
+        }
     }
-    Py_RETURN_NONE;
+    return Py_BuildValue("{sO sn sn sn sn sn sn}",
+        "deduplicate", self->deduplicate ? Py_True : Py_False,
+        "segment_bytes", (Py_ssize_t)segment_bytes, "resident_bytes", (Py_ssize_t)resident, "line_bytes", (Py_ssize_t)line_bytes, "shared_lines", (Py_ssize_t)shared_lines,
+        "pool_payloads", (Py_ssize_t)line_pool.num_payloads, "pool_bytes", (Py_ssize_t)line_pool.payload_bytes
+    );
 }
 
-
 // Boilerplate {{{
 static PyObject* rewrap(HistoryBuf *self, PyObject *args);
 #define rewrap_doc ""
@@ -511,10 +902,10 @@ static PyObject* rewrap(HistoryBuf *self, PyObject *args);
 static PyMethodDef methods[] = {
     METHOD(line, METH_O)
     METHODB(pagerhist_write, METH_O),
-    METHODB(pagerhist_rewrap, METH_O),
     METHODB(pagerhist_as_text, METH_VARARGS),
     METHODB(pagerhist_as_bytes, METH_VARARGS),
     METHOD(dirty_lines, METH_NOARGS)
+    METHOD(memory_usage, METH_NOARGS)
     METHOD(push, METH_VARARGS)
     METHOD(rewrap, METH_VARARGS)
     {NULL, NULL, 0, NULL}  /* Sentinel */
@@ -542,8 +933,8 @@ PyTypeObject HistoryBuf_Type = {
 
 INIT_TYPE(HistoryBuf)
 
-HistoryBuf *alloc_historybuf(unsigned int lines, unsigned int columns, unsigned int pagerhist_sz) {
-    return create_historybuf(&HistoryBuf_Type, columns, lines, pagerhist_sz);
+HistoryBuf *alloc_historybuf(unsigned int lines, unsigned int columns, unsigned int pagerhist_sz, bool deduplicate) {
+    return create_historybuf(&HistoryBuf_Type, columns, lines, pagerhist_sz, deduplicate);
 }
 // }}}
 
@@ -562,9 +953,18 @@ HistoryBuf *alloc_historybuf(unsigned int lines, unsigned int columns, unsigned
 void
 historybuf_rewrap(HistoryBuf *self, HistoryBuf *other, ANSIBuf *as_ansi_buf) {
     while(other->num_segments < self->num_segments) add_segment(other);
-    if (other->xnum == self->xnum && other->ynum == self->ynum) {
+    if (other->xnum == self->xnum && other->ynum == self->ynum && other->deduplicate == self->deduplicate) {
         // Fast path
-        for (index_type i = 0; i < self->num_segments; i++) {
+        for (index_type i = 0; i < self->num_segments && self->deduplicate; i++) {
+            for (index_type y = 0; y < SEGMENT_SIZE; y++) {
+                HistoryLine *l = self->segments[i].lines[y];
+                if (l) l->refcount++;
+                release_history_line(other->segments[i].lines[y]);
+                other->segments[i].lines[y] = l;
+            }
+            memcpy(other->segments[i].line_attrs, self->segments[i].line_attrs, SEGMENT_SIZE * sizeof(LineAttrs));
+        }
+        for (index_type i = 0; i < self->num_segments && !self->deduplicate; i++) {
             memcpy(other->segments[i].cpu_cells, self->segments[i].cpu_cells, SEGMENT_SIZE * self->xnum * sizeof(CPUCell));
             memcpy(other->segments[i].gpu_cells, self->segments[i].gpu_cells, SEGMENT_SIZE * self->xnum * sizeof(GPUCell));
             memcpy(other->segments[i].line_attrs, self->segments[i].line_attrs, SEGMENT_SIZE * sizeof(LineAttrs));
@@ -572,8 +972,6 @@ historybuf_rewrap(HistoryBuf *self, HistoryBuf *other, ANSIBuf *as_ansi_buf) {
         other->count = self->count; other->start_of_data = self->start_of_data;
         return;
     }
-    if (other->pagerhist && other->xnum != self->xnum && ringbuf_bytes_used(other->pagerhist->ringbuf))
-        other->pagerhist->rewrap_needed = true;
     other->count = 0; other->start_of_data = 0;
     if (self->count > 0) {
         rewrap_inner(self, other, self->count, NULL, NULL, as_ansi_buf);
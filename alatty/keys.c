@@ -8,6 +8,8 @@
 #include "state.h"
 #include "keys.h"
 #include "screen.h"
+#include "modes.h"
+#include "control-codes.h"
 #include "glfw-wrapper.h"
 #include <structmember.h>
 
@@ -156,6 +158,7 @@ on_key_input(GLFWkeyevent *ev) {
     if (OPT(mouse_hide_wait) < 0 && !is_modifier_key(key)) hide_mouse(global_state.callback_os_window);
     Screen *screen = w->render_data.screen;
     id_type active_window_id = w->id;
+    screen->last_key_input_at = monotonic();
 
     switch(ev->ime_state) {
         case GLFW_IME_WAYLAND_DONE_EVENT:
@@ -271,6 +274,115 @@ pyencode_key_for_tty(PyObject *self UNUSED, PyObject *args, PyObject *kw) {
     return PyUnicode_FromStringAndSize(output, MAX(0, num));
 }
 
+// Batch injection of input {{{
+typedef struct InputBuf {
+    char *buf;
+    size_t len, capacity;
+} InputBuf;
+
+static void
+append_to_input_buf(InputBuf *ib, const char *data, size_t sz) {
+    ensure_space_for(ib, buf, char, ib->len + sz, capacity, 4096, false);
+    memcpy(ib->buf + ib->len, data, sz);
+    ib->len += sz;
+}
+
+static void
+append_key_to_input_buf(InputBuf *ib, const GLFWkeyevent *ev, const Screen *screen, const uint8_t key_encoding_flags) {
+    char encoded_key[KEY_BUFFER_SIZE] = {0};
+    int size = encode_glfw_key_event(ev, screen->modes.mDECCKM, key_encoding_flags, encoded_key);
+    if (size == SEND_TEXT_TO_CHILD) append_to_input_buf(ib, ev->text, strlen(ev->text));
+    else if (size > 0) append_to_input_buf(ib, encoded_key, size);
+}
+
+static bool
+ends_with(const InputBuf *ib, size_t start, const char *suffix, size_t sz) {
+    return ib->len - start >= sz && memcmp(ib->buf + ib->len - sz, suffix, sz) == 0;
+}
+
+static void
+append_paste_to_input_buf(InputBuf *ib, const Screen *screen, const char *text, size_t sz) {
+    // This is the only place pasted text is sanitized, Window.paste_text() sends its text through here
+    static const char end[] = "\x1b[" BRACKETED_PASTE_END, c1_end[] = "\x9b" BRACKETED_PASTE_END;
+    if (!sz) return;
+    if (screen->modes.mBRACKETED_PASTE) {
+        const char *prefix, *suffix;
+        get_prefix_and_suffix_for_escape_code(screen, CSI, &prefix, &suffix);
+        const size_t prefix_sz = strlen(prefix);
+        append_to_input_buf(ib, prefix, prefix_sz);
+        append_to_input_buf(ib, BRACKETED_PASTE_START, sizeof(BRACKETED_PASTE_START) - 1);
+        const size_t text_start = ib->len;
+        for (size_t i = 0; i < sz; i++) {
+            append_to_input_buf(ib, text + i, 1);
+            // Remove end of paste markers, including ones formed by the removal of others
+            if (text[i] != '~') continue;
+            if (ends_with(ib, text_start, end, sizeof(end) - 1)) ib->len -= sizeof(end) - 1;
+            else if (ends_with(ib, text_start, c1_end, sizeof(c1_end) - 1)) ib->len -= sizeof(c1_end) - 1;
+        }
+        append_to_input_buf(ib, prefix, prefix_sz);
+        append_to_input_buf(ib, BRACKETED_PASTE_END, sizeof(BRACKETED_PASTE_END) - 1);
+    } else {
+        // Newlines are sent as carriage returns for editors that cannot handle newlines in pasted text
+        ensure_space_for(ib, buf, char, ib->len + sz, capacity, 4096, false);
+        for (size_t i = 0; i < sz; i++) {
+            if (text[i] != '\n') ib->buf[ib->len++] = text[i];
+            else if (!i || text[i-1] != '\r') ib->buf[ib->len++] = '\r';
+        }
+    }
+}
+
+static bool
+glfw_key_event_from_python(PyKeyEvent *k, GLFWkeyevent *ev) {
+    memset(ev, 0, sizeof(GLFWkeyevent));
+#define C(x) { ev->x = PyLong_AsUnsignedLong(k->x); if (PyErr_Occurred()) return false; }
+    C(key); C(shifted_key); C(alternate_key); C(mods); C(action);
+#undef C
+    ev->text = PyUnicode_AsUTF8(k->text);
+    return ev->text != NULL;
+}
+
+static PyObject*
+pyinject_input(PyObject *self UNUSED, PyObject *args, PyObject *kw) {
+    static char *kwds[] = {"window_id", "events", "synthesize_release_events", NULL};
+    unsigned long long window_id; PyObject *events; int synthesize_release_events = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kw, "KO|p", kwds, &window_id, &events, &synthesize_release_events)) return NULL;
+    RAII_PyObject(seq, PySequence_Fast(events, "events must be a sequence"));
+    if (!seq) return NULL;
+    Window *w = window_for_window_id(window_id);
+    if (!w || !w->render_data.screen) Py_RETURN_NONE;
+    Screen *screen = w->render_data.screen;
+    const uint8_t key_encoding_flags = screen_current_key_encoding_flags(screen);
+    InputBuf ib = {0};
+    for (Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE(seq); i++) {
+        PyObject *item = PySequence_Fast_GET_ITEM(seq, i);
+        if (PyObject_TypeCheck(item, &PyKeyEvent_Type)) {
+            GLFWkeyevent ev;
+            if (!glfw_key_event_from_python((PyKeyEvent*)item, &ev)) { free(ib.buf); return NULL; }
+            append_key_to_input_buf(&ib, &ev, screen, key_encoding_flags);
+            if (synthesize_release_events && ev.action != GLFW_RELEASE) {
+                GLFWkeyevent release = {.key = ev.key, .mods = ev.mods, .action = GLFW_RELEASE, .text = ""};
+                append_key_to_input_buf(&ib, &release, screen, key_encoding_flags);
+            }
+        } else if (PyUnicode_Check(item)) {
+            Py_ssize_t sz;
+            const char *text = PyUnicode_AsUTF8AndSize(item, &sz);
+            if (!text) { free(ib.buf); return NULL; }
+            append_paste_to_input_buf(&ib, screen, text, sz);
+        } else if (PyBytes_Check(item)) {
+            append_paste_to_input_buf(&ib, screen, PyBytes_AS_STRING(item), PyBytes_GET_SIZE(item));
+        } else {
+            free(ib.buf);
+            PyErr_Format(PyExc_TypeError, "Input events must be KeyEvent, str or bytes objects not: %s", Py_TYPE(item)->tp_name);
+            return NULL;
+        }
+    }
+    const size_t len = ib.len;
+    if (len && !schedule_write_to_child(w->id, 1, ib.buf, len)) { free(ib.buf); Py_RETURN_NONE; }
+    free(ib.buf);
+    return PyLong_FromSize_t(len);
+}
+// }}}
+
 static PyObject*
 pyis_modifier_key(PyObject *self UNUSED, PyObject *a) {
     unsigned long key = PyLong_AsUnsignedLong(a);
@@ -282,6 +394,7 @@ pyis_modifier_key(PyObject *self UNUSED, PyObject *a) {
 static PyMethodDef module_methods[] = {
     M(key_for_native_key_name, METH_VARARGS),
     M(encode_key_for_tty, METH_VARARGS | METH_KEYWORDS),
+    M(inject_input, METH_VARARGS | METH_KEYWORDS),
     M(is_modifier_key, METH_O),
     {0}
 };
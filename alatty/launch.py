@@ -515,14 +515,15 @@ def _launch(
             tab = tab_for_window(boss, opts, target_tab)
         if tab is not None:
             watchers = load_watch_modules(opts.watcher)
-            with Window.set_ignore_focus_changes_for_new_windows(opts.keep_focus):
-                new_window: Window = tab.new_window(
-                    env=env or None, watchers=watchers or None, is_clone_launch=is_clone_launch, **kw)
-            if opts.keep_focus:
-                if active:
-                    boss.set_active_window(active, switch_os_window_if_needed=True, for_keep_focus=True)
-                if not Window.initial_ignore_focus_changes_context_manager_in_operation:
-                    new_window.ignore_focus_changes = False
+            with tab.batched_relayout():
+                with Window.set_ignore_focus_changes_for_new_windows(opts.keep_focus):
+                    new_window: Window = tab.new_window(
+                        env=env or None, watchers=watchers or None, is_clone_launch=is_clone_launch, **kw)
+                if opts.keep_focus:
+                    if active:
+                        boss.set_active_window(active, switch_os_window_if_needed=True, for_keep_focus=True)
+                    if not Window.initial_ignore_focus_changes_context_manager_in_operation:
+                        new_window.ignore_focus_changes = False
             if opts.type == 'overlay-main':
                 new_window.overlay_type = OverlayType.main
             if opts.var:
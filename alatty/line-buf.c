@@ -91,10 +91,11 @@ new(PyTypeObject *type, PyObject *args, PyObject UNUSED *kwds) {
         self->line_map = PyMem_Calloc(ynum, sizeof(index_type));
         self->scratch = PyMem_Calloc(ynum, sizeof(index_type));
         self->line_attrs = PyMem_Calloc(ynum, sizeof(LineAttrs));
+        self->scratch_attrs = PyMem_Calloc(ynum, sizeof(LineAttrs));
         self->line = alloc_line();
-        if (self->cpu_cell_buf == NULL || self->gpu_cell_buf == NULL || self->line_map == NULL || self->scratch == NULL || self->line_attrs == NULL || self->line == NULL) {
+        if (self->cpu_cell_buf == NULL || self->gpu_cell_buf == NULL || self->line_map == NULL || self->scratch == NULL || self->line_attrs == NULL || self->scratch_attrs == NULL || self->line == NULL) {
+            // dealloc() frees whichever of the buffers were allocated
             PyErr_NoMemory();
-            PyMem_Free(self->cpu_cell_buf); PyMem_Free(self->gpu_cell_buf); PyMem_Free(self->line_map); PyMem_Free(self->line_attrs); Py_CLEAR(self->line);
             Py_CLEAR(self);
         } else {
             self->line->xnum = xnum;
@@ -115,6 +116,7 @@ dealloc(LineBuf* self) {
     PyMem_Free(self->line_map);
     PyMem_Free(self->line_attrs);
     PyMem_Free(self->scratch);
+    PyMem_Free(self->scratch_attrs);
     Py_CLEAR(self->line);
     Py_TYPE(self)->tp_free((PyObject*)self);
 }
@@ -280,17 +282,44 @@ clear_line(LineBuf *self, PyObject *val) {
     Py_RETURN_NONE;
 }
 
+static void
+rotate_lines_up(LineBuf *self, index_type top, index_type bottom, index_type num) {
+    // Move the lines in [top, bottom] up by num, the num lines at top end up at the bottom
+    const index_type count = bottom + 1 - top;
+    memcpy(self->scratch, self->line_map + top, num * sizeof(self->line_map[0]));
+    memcpy(self->scratch_attrs, self->line_attrs + top, num * sizeof(self->line_attrs[0]));
+    memmove(self->line_map + top, self->line_map + top + num, (count - num) * sizeof(self->line_map[0]));
+    memmove(self->line_attrs + top, self->line_attrs + top + num, (count - num) * sizeof(self->line_attrs[0]));
+    memcpy(self->line_map + bottom + 1 - num, self->scratch, num * sizeof(self->line_map[0]));
+    memcpy(self->line_attrs + bottom + 1 - num, self->scratch_attrs, num * sizeof(self->line_attrs[0]));
+}
+
+static void
+rotate_lines_down(LineBuf *self, index_type top, index_type bottom, index_type num) {
+    // Move the lines in [top, bottom] down by num, the num lines at bottom end up at the top
+    const index_type count = bottom + 1 - top;
+    memcpy(self->scratch, self->line_map + bottom + 1 - num, num * sizeof(self->line_map[0]));
+    memcpy(self->scratch_attrs, self->line_attrs + bottom + 1 - num, num * sizeof(self->line_attrs[0]));
+    memmove(self->line_map + top + num, self->line_map + top, (count - num) * sizeof(self->line_map[0]));
+    memmove(self->line_attrs + top + num, self->line_attrs + top, (count - num) * sizeof(self->line_attrs[0]));
+    memcpy(self->line_map + top, self->scratch, num * sizeof(self->line_map[0]));
+    memcpy(self->line_attrs + top, self->scratch_attrs, num * sizeof(self->line_attrs[0]));
+}
+
+static void
+clear_lines(LineBuf *self, index_type y, index_type num) {
+    Line l;
+    for (index_type i = y; i < y + num; i++) {
+        init_line(self, &l, self->line_map[i]);
+        clear_line_(&l, self->xnum);
+    }
+    zero_at_ptr_count(self->line_attrs + y, num);
+}
+
 void
 linebuf_index(LineBuf* self, index_type top, index_type bottom) {
     if (top >= self->ynum - 1 || bottom >= self->ynum || bottom <= top) return;
-    index_type old_top = self->line_map[top];
-    LineAttrs old_attrs = self->line_attrs[top];
-    for (index_type i = top; i < bottom; i++) {
-        self->line_map[i] = self->line_map[i + 1];
-        self->line_attrs[i] = self->line_attrs[i + 1];
-    }
-    self->line_map[bottom] = old_top;
-    self->line_attrs[bottom]= old_attrs;
+    rotate_lines_up(self, top, bottom, 1);
 }
 
 static PyObject*
@@ -305,14 +334,7 @@ pyw_index(LineBuf *self, PyObject *args) {
 void
 linebuf_reverse_index(LineBuf *self, index_type top, index_type bottom) {
     if (top >= self->ynum - 1 || bottom >= self->ynum || bottom <= top) return;
-    index_type old_bottom = self->line_map[bottom];
-    LineAttrs old_attrs = self->line_attrs[bottom];
-    for (index_type i = bottom; i > top; i--) {
-        self->line_map[i] = self->line_map[i - 1];
-        self->line_attrs[i] = self->line_attrs[i - 1];
-    }
-    self->line_map[top] = old_bottom;
-    self->line_attrs[top] = old_attrs;
+    rotate_lines_down(self, top, bottom, 1);
 }
 
 static PyObject*
@@ -336,27 +358,11 @@ is_continued(LineBuf *self, PyObject *val) {
 
 void
 linebuf_insert_lines(LineBuf *self, unsigned int num, unsigned int y, unsigned int bottom) {
-    index_type i;
     if (y >= self->ynum || y > bottom || bottom >= self->ynum) return;
-    index_type ylimit = bottom + 1;
-    num = MIN(ylimit - y, num);
+    num = MIN(bottom + 1 - y, num);
     if (num > 0) {
-        for (i = ylimit - num; i < ylimit; i++) {
-            self->scratch[i] = self->line_map[i];
-        }
-        for (i = ylimit - 1; i >= y + num; i--) {
-            self->line_map[i] = self->line_map[i - num];
-            self->line_attrs[i] = self->line_attrs[i - num];
-        }
-        for (i = 0; i < num; i++) {
-            self->line_map[y + i] = self->scratch[ylimit - num + i];
-        }
-        Line l;
-        for (i = y; i < y + num; i++) {
-            init_line(self, &l, self->line_map[i]);
-            clear_line_(&l, self->xnum);
-            self->line_attrs[i].val = 0;
-        }
+        rotate_lines_down(self, y, bottom, num);
+        clear_lines(self, y, num);
     }
 }
 
@@ -371,26 +377,11 @@ insert_lines(LineBuf *self, PyObject *args) {
 
 void
 linebuf_delete_lines(LineBuf *self, index_type num, index_type y, index_type bottom) {
-    index_type i;
-    index_type ylimit = bottom + 1;
+    if (y >= self->ynum || y > bottom || bottom >= self->ynum) return;
     num = MIN(bottom + 1 - y, num);
-    if (y >= self->ynum || y > bottom || bottom >= self->ynum || num < 1) return;
-    for (i = y; i < y + num; i++) {
-        self->scratch[i] = self->line_map[i];
-    }
-    for (i = y; i < ylimit && i + num < self->ynum; i++) {
-        self->line_map[i] = self->line_map[i + num];
-        self->line_attrs[i] = self->line_attrs[i + num];
-    }
-    for (i = 0; i < num; i++) {
-        self->line_map[ylimit - num + i] = self->scratch[y + i];
-    }
-    Line l;
-    for (i = ylimit - num; i < ylimit; i++) {
-        init_line(self, &l, self->line_map[i]);
-        clear_line_(&l, self->xnum);
-        self->line_attrs[i].val = 0;
-    }
+    if (num < 1) return;
+    rotate_lines_up(self, y, bottom, num);
+    clear_lines(self, bottom + 1 - num, num);
 }
 
 static PyObject*
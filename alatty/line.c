@@ -142,6 +142,11 @@ sprite_at(Line* self, PyObject *x) {
     return Py_BuildValue("HHH", c->sprite_x, c->sprite_y, c->sprite_z);
 }
 
+static inline bool
+cells_have_same_sgr(const GPUCell *a, const GPUCell *b, const uint16_t sgr_mask) {
+    return a->fg == b->fg && a->bg == b->bg && a->decoration_fg == b->decoration_fg && (a->attrs.val & sgr_mask) == (b->attrs.val & sgr_mask);
+}
+
 static void
 write_sgr(const char *val, ANSIBuf *output) {
 #define W(c) output->buf[output->len++] = c
@@ -190,41 +195,45 @@ line_as_ansi(Line *self, ANSIBuf *output, const GPUCell** prev_cell, index_type
     if (limit <= start_at) return escape_code_written;
 
     static const GPUCell blank_cell = { 0 };
-    GPUCell *cell;
     if (*prev_cell == NULL) *prev_cell = &blank_cell;
-    const CellAttrs mask_for_sgr = {.val=SGR_MASK};
-
-    for (index_type pos=start_at; pos < limit; pos++) {
-        char_type ch = self->cpu_cells[pos].ch;
-        if (ch == 0) {
-            if (previous_width == 2) { previous_width = 0; continue; }
-            ch = ' ';
-        }
-        cell = &self->gpu_cells[pos];
-
-#define CMP_ATTRS (cell->attrs.val & mask_for_sgr.val) != ((*prev_cell)->attrs.val & mask_for_sgr.val)
-#define CMP(x) cell->x != (*prev_cell)->x
-        if (CMP_ATTRS || CMP(fg) || CMP(bg) || CMP(decoration_fg)) {
+    const uint16_t sgr_mask = SGR_MASK;
+    const GPUCell *gpu_cells = self->gpu_cells;
+    const CPUCell *cpu_cells = self->cpu_cells;
+
+    for (index_type pos = start_at; pos < limit;) {
+        if (cpu_cells[pos].ch == 0 && previous_width == 2) { previous_width = 0; pos++; continue; }
+        const GPUCell *cell = gpu_cells + pos;
+        if (!cells_have_same_sgr(cell, *prev_cell, sgr_mask)) {
             const char *sgr = cell_as_sgr(cell, *prev_cell);
             if (*sgr) WRITE_SGR(sgr);
         }
         *prev_cell = cell;
-        WRITE_CH(ch);
-        if (ch == '\t') {
-            unsigned num_cells_to_skip_for_tab = self->cpu_cells[pos].cc_idx[0];
-            while (num_cells_to_skip_for_tab && pos + 1 < limit && self->cpu_cells[pos+1].ch == ' ') {
-                num_cells_to_skip_for_tab--; pos++;
+        // All cells in [pos, run_end) render with the same SGR, so their text can be written without any further checks
+        index_type run_end = pos + 1;
+        while (run_end < limit && cells_have_same_sgr(gpu_cells + run_end, cell, sgr_mask)) run_end++;
+        ENSURE_SPACE((run_end - pos) * (1 + arraysz(cpu_cells[pos].cc_idx)));
+        Py_UCS4 *out = output->buf + output->len;
+        for (; pos < run_end; pos++) {
+            const CPUCell *c = cpu_cells + pos;
+            char_type ch = c->ch;
+            if (ch == 0) {
+                if (previous_width == 2) { previous_width = 0; continue; }
+                ch = ' ';
             }
-        } else {
-            for(unsigned c = 0; c < arraysz(self->cpu_cells[pos].cc_idx) && self->cpu_cells[pos].cc_idx[c]; c++) {
-                WRITE_CH(codepoint_for_mark(self->cpu_cells[pos].cc_idx[c]));
+            *out++ = ch;
+            previous_width = gpu_cells[pos].attrs.width;
+            if (ch == '\t') {
+                unsigned num_cells_to_skip_for_tab = c->cc_idx[0];
+                while (num_cells_to_skip_for_tab && pos + 1 < limit && cpu_cells[pos+1].ch == ' ') {
+                    num_cells_to_skip_for_tab--; pos++;
+                }
+            } else {
+                for (unsigned i = 0; i < arraysz(c->cc_idx) && c->cc_idx[i]; i++) *out++ = codepoint_for_mark(c->cc_idx[i]);
             }
         }
-        previous_width = cell->attrs.width;
+        output->len = out - output->buf;
     }
     return escape_code_written;
-#undef CMP_ATTRS
-#undef CMP
 #undef WRITE_SGR
 #undef WRITE_CH
 #undef ENSURE_SPACE
@@ -493,20 +502,38 @@ set_attribute(Line *self, PyObject *args) {
     Py_RETURN_NONE;
 }
 
+static char*
+write_uint(char *p, unsigned long val) {
+    char digits[24]; unsigned n = 0;
+    do { digits[n++] = '0' + val % 10; val /= 10; } while (val);
+    while (n) *p++ = digits[--n];
+    return p;
+}
+
 static int
 color_as_sgr(char *buf, size_t sz, unsigned long val, unsigned simple_code, unsigned aix_code, unsigned complex_code) {
+    // The longest possible output is: 58:2:255:255:255;
+    if (sz < 32) return 0;
+    char *p = buf;
     switch(val & 0xff) {
         case 1:
             val >>= 8;
             if (val < 16 && simple_code) {
-                return snprintf(buf, sz, "%lu;", (val < 8) ? simple_code + val : aix_code + (val - 8));
+                p = write_uint(p, (val < 8) ? simple_code + val : aix_code + (val - 8));
+            } else {
+                p = write_uint(p, complex_code); *p++ = ':'; *p++ = '5'; *p++ = ':'; p = write_uint(p, val);
             }
-            return snprintf(buf, sz, "%u:5:%lu;", complex_code, val);
+            break;
         case 2:
-            return snprintf(buf, sz, "%u:2:%lu:%lu:%lu;", complex_code, (val >> 24) & 0xff, (val >> 16) & 0xff, (val >> 8) & 0xff);
+            p = write_uint(p, complex_code); *p++ = ':'; *p++ = '2';
+            for (unsigned shift = 24; shift >= 8; shift -= 8) { *p++ = ':'; p = write_uint(p, (val >> shift) & 0xff); }
+            break;
         default:
-            return snprintf(buf, sz, "%u;", complex_code + 1);  // reset
+            p = write_uint(p, complex_code + 1);  // reset
+            break;
     }
+    *p++ = ';';
+    return p - buf;
 }
 
 static const char*
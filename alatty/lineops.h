@@ -115,6 +115,8 @@ void historybuf_add_line(HistoryBuf *self, const Line *line, ANSIBuf*);
 bool historybuf_pop_line(HistoryBuf *, Line *);
 void historybuf_rewrap(HistoryBuf *self, HistoryBuf *other, ANSIBuf*);
 void historybuf_init_line(HistoryBuf *self, index_type num, Line *l);
+void historybuf_init_line_for_rendering(HistoryBuf *self, index_type lnum, Line *l);
+void historybuf_finish_rendering_line(HistoryBuf *self, index_type lnum, Line *l);
 bool history_buf_endswith_wrap(HistoryBuf *self);
 CPUCell* historybuf_cpu_cells(HistoryBuf *self, index_type num);
 void historybuf_mark_line_clean(HistoryBuf *self, index_type y);
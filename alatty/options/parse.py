@@ -280,6 +280,9 @@ def resize_debounce_time(self, val: str, ans: typing.Dict[str, typing.Any]) -> N
     def resize_in_steps(self, val: str, ans: typing.Dict[str, typing.Any]) -> None:
         ans['resize_in_steps'] = to_bool(val)
 
+    def scrollback_deduplicate(self, val: str, ans: typing.Dict[str, typing.Any]) -> None:
+        ans['scrollback_deduplicate'] = to_bool(val)
+
     def scrollback_fill_enlarged_window(self, val: str, ans: typing.Dict[str, typing.Any]) -> None:
         ans['scrollback_fill_enlarged_window'] = to_bool(val)
 
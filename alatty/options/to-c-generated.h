@@ -135,6 +135,19 @@ convert_from_opts_scrollback_pager_history_size(PyObject *py_opts, Options *opts
     Py_DECREF(ret);
 }
 
+static void
+convert_from_python_scrollback_deduplicate(PyObject *val, Options *opts) {
+    opts->scrollback_deduplicate = PyObject_IsTrue(val);
+}
+
+static void
+convert_from_opts_scrollback_deduplicate(PyObject *py_opts, Options *opts) {
+    PyObject *ret = PyObject_GetAttrString(py_opts, "scrollback_deduplicate");
+    if (ret == NULL) return;
+    convert_from_python_scrollback_deduplicate(ret, opts);
+    Py_DECREF(ret);
+}
+
 static void
 convert_from_python_scrollback_fill_enlarged_window(PyObject *val, Options *opts) {
     opts->scrollback_fill_enlarged_window = PyObject_IsTrue(val);
@@ -690,6 +703,8 @@ convert_opts_from_python_opts(PyObject *py_opts, Options *opts) {
     if (PyErr_Occurred()) return false;
     convert_from_opts_scrollback_pager_history_size(py_opts, opts);
     if (PyErr_Occurred()) return false;
+    convert_from_opts_scrollback_deduplicate(py_opts, opts);
+    if (PyErr_Occurred()) return false;
     convert_from_opts_scrollback_fill_enlarged_window(py_opts, opts);
     if (PyErr_Occurred()) return false;
     convert_from_opts_wheel_scroll_multiplier(py_opts, opts);
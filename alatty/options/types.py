@@ -102,6 +102,7 @@
  'repaint_delay',
  'resize_debounce_time',
  'resize_in_steps',
+ 'scrollback_deduplicate',
  'scrollback_fill_enlarged_window',
  'scrollback_lines',
  'scrollback_pager',
@@ -208,6 +209,7 @@ class Options:
     repaint_delay: int = 10
     resize_debounce_time: typing.Tuple[float, float] = (0.1, 0.5)
     resize_in_steps: bool = False
+    scrollback_deduplicate: bool = False
     scrollback_fill_enlarged_window: bool = False
     scrollback_lines: int = 2000
     scrollback_pager: typing.List[str] = ['less', '--chop-long-lines', '--RAW-CONTROL-CHARS', '+INPUT_LINE_NUMBER']
@@ -19,6 +19,8 @@
 extern PyTypeObject Screen_Type;
 #define EXTENDED_OSC_SENTINEL 0x1bu
 #define PENDING_BUF_INCREMENT (16u * 1024u)
+// The amount of input parsed between checks of the parse deadline
+#define PARSE_CHUNK_SZ (16u * 1024u)
 
 // utils {{{
 static const uint64_t pow_10_array[] = {
@@ -1487,14 +1489,25 @@ FNAME(parse_bytes)(PyObject UNUSED *self, PyObject *args) {
 
 
 void
-FNAME(parse_worker)(Screen *screen, PyObject *dump_callback, monotonic_t now) {
+FNAME(parse_worker)(Screen *screen, PyObject *dump_callback, monotonic_t now, monotonic_t deadline) {
+    // Parse the read buffer in chunks. If deadline is non-zero, stop once it has
+    // passed, leaving the unparsed bytes at the start of the read buffer.
+    size_t consumed = 0;
+    screen->pending_replies.batching = true;
+    do {
+        const size_t chunk = MIN(PARSE_CHUNK_SZ, screen->read_buf_sz - consumed);
 #ifdef DUMP_COMMANDS
-    if (screen->read_buf_sz) {
-        Py_XDECREF(PyObject_CallFunction(dump_callback, "sy#", "bytes", screen->read_buf, screen->read_buf_sz)); PyErr_Clear();
-    }
+        if (chunk) {
+            Py_XDECREF(PyObject_CallFunction(dump_callback, "sy#", "bytes", screen->read_buf + consumed, chunk)); PyErr_Clear();
+        }
 #endif
-    do_parse_bytes(screen, screen->read_buf, screen->read_buf_sz, now, dump_callback);
-    screen->read_buf_sz = 0;
+        do_parse_bytes(screen, screen->read_buf + consumed, chunk, now, dump_callback);
+        consumed += chunk;
+    } while (consumed < screen->read_buf_sz && (!deadline || monotonic() < deadline));
+    screen->pending_replies.batching = false;
+    screen_flush_pending_replies(screen);
+    if (consumed < screen->read_buf_sz) memmove(screen->read_buf, screen->read_buf + consumed, screen->read_buf_sz - consumed);
+    screen->read_buf_sz -= consumed;
 }
 #undef FNAME
 // }}}
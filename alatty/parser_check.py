@@ -0,0 +1,202 @@
+#!/usr/bin/env python
+# License: GPLv3 Copyright: 2026, alatty contributors
+
+# Differential checking of the VT parser. The same byte stream is fed to
+# one screen a single byte at a time, which exercises only the reference
+# byte-at-a-time code paths, and to other screens in large or randomly split
+# chunks, which exercise whatever batched fast paths the parser uses. The
+# resulting screen states must be identical.
+
+import os
+import random
+import sys
+from typing import Any, Callable, Dict, Iterator, List, Optional, Sequence, Tuple
+
+Snapshot = Dict[str, Any]
+
+LINES, COLUMNS, SCROLLBACK = 24, 80, 200
+# Fragments that are spliced into inputs when fuzzing, to reach escape code handling quickly
+INTERESTING = (
+    b'\x1b[', b'\x1b]', b'\x1bP', b'\x1b^', b'\x1b_', b'\x1b\\', b'\x07', b'\x1b[?2026h', b'\x1b[?2026l',
+    b'\x1bP=1s\x1b\\', b'\x1bP=2s\x1b\\', b'\x1b[?1049h', b'\x1b[?1049l', b'\x1b[3;20r', b'\x1b[r', b'\x1b[5S',
+    b'\x1b[5T', b'\x1b[5L', b'\x1b[5M', b'\x1b[10b', b'\x1b[1;31;4:3m', b'\x1b[38:2:1:2:3m', b'\x1b[m', b'\x1b[6n',
+    b'\x1b[c', b'\x1b]0;title\x07', b'\x1b]8;;http://x\x1b\\', b'\x1b#8', b'\r\n', b'\n' * 30, b'\t', b'\x08',
+    'é́'.encode(), '😀'.encode(), '一'.encode(), b'\xe2\x82', b'\xff', b';', b':', b'?', b'>', b'0123456789',
+)
+
+
+class Recorder:
+
+    def __init__(self) -> None:
+        self.calls: List[Tuple[str, Tuple[Any, ...]]] = []
+        self.replies = bytearray()
+
+    def write(self, data: bytes) -> None:
+        self.replies.extend(data)
+
+    def __getattr__(self, name: str) -> Callable[..., None]:
+        if name.startswith('__'):
+            raise AttributeError(name)
+
+        def record(*args: Any) -> None:
+            self.calls.append((name, tuple(bytes(a) if isinstance(a, memoryview) else a for a in args)))
+        return record
+
+
+def text_of(func: Callable[..., None], *args: Any) -> str:
+    parts: List[str] = []
+    func(parts.append, *args)
+    return ''.join(parts)
+
+
+def snapshot(screen: Any, recorder: Recorder) -> Snapshot:
+    return {
+        'main': text_of(screen.as_text_non_visual, True, True),
+        'alternate': text_of(screen.as_text_alternate, True, True),
+        'history': text_of(screen.as_text_for_history_buf, True, True),
+        'cursor': repr(screen.cursor),
+        'cursor_visible': screen.cursor_visible,
+        'cursor_key_mode': screen.cursor_key_mode,
+        'bracketed_paste': screen.in_bracketed_paste_mode,
+        'alternate_screen': screen.is_using_alternate_linebuf(),
+        'key_encoding_flags': screen.current_key_encoding_flags(),
+        'replies': bytes(recorder.replies),
+        'callbacks': list(recorder.calls),
+    }
+
+
+def run(data: bytes, chunks: Iterator[int]) -> Snapshot:
+    from .fast_data_types import Screen, parse_bytes
+    recorder = Recorder()
+    screen = Screen(recorder, LINES, COLUMNS, SCROLLBACK, 10, 20, 0, recorder)
+    pos = 0
+    while pos < len(data):
+        n = max(1, next(chunks))
+        parse_bytes(screen, data[pos:pos + n])
+        pos += n
+    return snapshot(screen, recorder)
+
+
+def forever(n: int) -> Iterator[int]:
+    while True:
+        yield n
+
+
+def random_splits(rng: random.Random) -> Iterator[int]:
+    while True:
+        yield rng.choice((1, 2, 3, rng.randint(1, 64), rng.randint(1, 4096)))
+
+
+def differences(a: Snapshot, b: Snapshot) -> List[str]:
+    return [k for k in a if a[k] != b[k]]
+
+
+def check(data: bytes, seed: int = 0) -> List[str]:
+    ' Return a description of every way the chunked parses of data differ from the byte-at-a-time reference '
+    reference = run(data, forever(1))
+    failures = []
+    for name, chunks in (('whole', forever(len(data) or 1)), ('random-split', random_splits(random.Random(seed)))):
+        diff = differences(reference, run(data, chunks))
+        if diff:
+            failures.append(f'{name}: {", ".join(diff)}')
+    return failures
+
+
+def mutate(data: bytes, rng: random.Random, corpus: Sequence[bytes]) -> bytes:
+    b = bytearray(data)
+    for i in range(rng.randint(1, 8)):
+        op = rng.randrange(5)
+        pos = rng.randint(0, len(b))
+        if op == 0 and b:
+            b[min(pos, len(b) - 1)] = rng.randrange(256)
+        elif op == 1:
+            b[pos:pos] = rng.choice(INTERESTING)
+        elif op == 2:
+            del b[pos:pos + rng.randint(1, 16)]
+        elif op == 3 and corpus:
+            other = rng.choice(corpus)
+            start = rng.randint(0, len(other))
+            b[pos:pos] = other[start:start + rng.randint(1, 256)]
+        else:
+            b[pos:pos] = bytes(rng.randrange(32, 127) for i in range(rng.randint(1, 32)))
+    return bytes(b)
+
+
+def read_corpus(paths: Sequence[str]) -> Iterator[Tuple[str, bytes]]:
+    for path in paths:
+        if os.path.isdir(path):
+            for dirpath, dirnames, filenames in os.walk(path):
+                dirnames.sort()
+                for x in sorted(filenames):
+                    q = os.path.join(dirpath, x)
+                    with open(q, 'rb') as f:
+                        yield q, f.read()
+        else:
+            with open(path, 'rb') as f:
+                yield path, f.read()
+
+
+def fuzz(corpus: List[bytes], iterations: int, seed: int, failures_dir: Optional[str]) -> int:
+    rng = random.Random(seed)
+    seen = {hash(x) for x in corpus}
+    num_failures = 0
+    for i in range(iterations):
+        data = mutate(rng.choice(corpus) if corpus else b'', rng, corpus)
+        failures = check(data, seed + i)
+        if failures:
+            num_failures += 1
+            print(f'Iteration {i}:', '; '.join(failures), file=sys.stderr)
+            if failures_dir:
+                os.makedirs(failures_dir, exist_ok=True)
+                with open(os.path.join(failures_dir, f'failure-{seed}-{i}'), 'wb') as f:
+                    f.write(data)
+        elif hash(data) not in seen and len(corpus) < 4096:
+            # inputs that parse consistently become seeds for further mutation
+            seen.add(hash(data))
+            corpus.append(data)
+    return num_failures
+
+
+usage = '''\
+usage: alatty +parser-check [--fuzz ITERATIONS] [--seed SEED] [--failures-dir DIR] [corpus files or directories ...]
+
+Feed every input in the corpus to the VT parser one byte at a time and in
+larger chunks and report any differences in the resulting screen state, replies
+to the child or callbacks. With --fuzz, additionally run the specified number
+of randomly mutated inputs derived from the corpus, saving failing inputs to
+--failures-dir, if specified, for later replay.'''
+
+
+def main(args: List[str]) -> None:
+    from .fast_data_types import set_options
+    from .options.types import defaults
+    iterations, seed, failures_dir, paths = 0, 0, None, []
+    it = iter(args[1:])
+    try:
+        for arg in it:
+            if arg in ('-h', '--help'):
+                raise SystemExit(usage)
+            if arg == '--fuzz':
+                iterations = int(next(it))
+            elif arg == '--seed':
+                seed = int(next(it))
+            elif arg == '--failures-dir':
+                failures_dir = next(it)
+            else:
+                paths.append(arg)
+    except (StopIteration, ValueError):
+        raise SystemExit(usage)
+    set_options(defaults)
+    corpus, num_failures = [], 0
+    for path, data in read_corpus(paths):
+        corpus.append(data)
+        failures = check(data, seed)
+        if failures:
+            num_failures += 1
+            print(f'{path}:', '; '.join(failures), file=sys.stderr)
+    print(f'Checked {len(corpus)} corpus inputs')
+    if iterations:
+        num_failures += fuzz(corpus, iterations, seed, failures_dir)
+        print(f'Ran {iterations} fuzz iterations')
+    if num_failures:
+        raise SystemExit(f'{num_failures} inputs parsed differently when chunked')
@@ -299,6 +299,33 @@ ringbuf_memcpy_from(void *dst, const ringbuf_t src, size_t count)
     return count;
 }
 
+static void
+reverse_bytes(uint8_t *start, uint8_t *end)
+{
+    while (start < end) {
+        uint8_t t = *start;
+        *start++ = *--end;
+        *end = t;
+    }
+}
+
+const void *
+ringbuf_linearize(ringbuf_t rb)
+{
+    size_t bytes_used = ringbuf_bytes_used(rb);
+    if (rb->tail != rb->buf && rb->head < rb->tail) {
+        /* rotate the whole buffer left so that the tail is at its start */
+        uint8_t *bufend = (uint8_t*)ringbuf_end(rb);
+        reverse_bytes(rb->buf, rb->tail);
+        reverse_bytes(rb->tail, bufend);
+        reverse_bytes(rb->buf, bufend);
+        rb->tail = rb->buf;
+        rb->head = rb->buf + bytes_used;
+    }
+    assert(ringbuf_bytes_used(rb) == bytes_used);
+    return rb->tail;
+}
+
 
 ssize_t
 ringbuf_write(int fd, ringbuf_t rb, size_t count)
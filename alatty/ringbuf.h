@@ -180,6 +180,14 @@ ringbuf_move_char(ringbuf_t src);
 size_t
 ringbuf_memcpy_from(void *dst, const ringbuf_t src, size_t count);
 
+/*
+ * Rotate the contents of the ring buffer rb in place so that the bytes
+ * used are contiguous, starting at the tail pointer, and return the
+ * tail pointer. Does not change the logical contents of the buffer.
+ */
+const void *
+ringbuf_linearize(ringbuf_t rb);
+
 /*
  * This convenience function calls write(2) on the file descriptor fd,
  * using the ring buffer rb as the source buffer for writing (starting
@@ -46,21 +46,64 @@ init_tabstops(bool *tabstops, index_type count) {
     }
 }
 
+// All the per screen arrays whose size depends only on the screen geometry
+// live in a single allocation, so that creating, resizing and destroying a
+// screen each cost one call into the allocator
+typedef struct ScreenArena {
+    uint8_t *mem;
+    GPUCell *gpu_rows, *overlay_gpu_cells, *original_gpu_cells;
+    CPUCell *overlay_cpu_cells, *original_cpu_cells;
+    bool *changed_rows, *tabstops;
+} ScreenArena;
+
+static size_t
+arena_slot(size_t *offset, size_t count, size_t size, size_t align) {
+    const size_t ans = (*offset + align - 1) / align * align;
+    *offset = ans + count * size;
+    return ans;
+}
+
 static bool
-init_overlay_line(Screen *self, index_type columns, bool keep_active) {
-    PyMem_Free(self->overlay_line.cpu_cells);
-    PyMem_Free(self->overlay_line.gpu_cells);
-    PyMem_Free(self->overlay_line.original_line.cpu_cells);
-    PyMem_Free(self->overlay_line.original_line.gpu_cells);
-    self->overlay_line.cpu_cells = PyMem_Calloc(columns, sizeof(CPUCell));
-    self->overlay_line.gpu_cells = PyMem_Calloc(columns, sizeof(GPUCell));
-    self->overlay_line.original_line.cpu_cells = PyMem_Calloc(columns, sizeof(CPUCell));
-    self->overlay_line.original_line.gpu_cells = PyMem_Calloc(columns, sizeof(GPUCell));
-    if (!self->overlay_line.cpu_cells || !self->overlay_line.gpu_cells ||
-        !self->overlay_line.original_line.cpu_cells || !self->overlay_line.original_line.gpu_cells) {
-        PyErr_NoMemory(); return false;
-    }
-    if (!keep_active) {
+alloc_screen_arena(ScreenArena *a, index_type lines, index_type columns) {
+    size_t sz = 0, gpu_rows, overlay_gpu_cells, original_gpu_cells, overlay_cpu_cells, original_cpu_cells, changed_rows, tabstops;
+#define S(which, count, type) which = arena_slot(&sz, count, sizeof(type), _Alignof(type))
+    S(gpu_rows, (size_t)lines * columns, GPUCell);
+    S(overlay_gpu_cells, columns, GPUCell); S(original_gpu_cells, columns, GPUCell);
+    S(overlay_cpu_cells, columns, CPUCell); S(original_cpu_cells, columns, CPUCell);
+    S(changed_rows, lines, bool); S(tabstops, 2 * (size_t)columns, bool);
+#undef S
+    a->mem = PyMem_Calloc(1, sz);
+    if (!a->mem) { PyErr_NoMemory(); return false; }
+#define S(which, type) a->which = (type*)(a->mem + which)
+    S(gpu_rows, GPUCell); S(overlay_gpu_cells, GPUCell); S(original_gpu_cells, GPUCell);
+    S(overlay_cpu_cells, CPUCell); S(original_cpu_cells, CPUCell);
+    S(changed_rows, bool); S(tabstops, bool);
+#undef S
+    return true;
+}
+
+static void
+use_screen_arena(Screen *self, ScreenArena *a, bool keep_overlay_active) {
+    // Must be called with self->columns and self->lines already set to the geometry the arena was allocated for
+    PyMem_Free(self->arena);
+    self->arena = a->mem;
+
+    self->main_tabstops = a->tabstops;
+    self->alt_tabstops = self->main_tabstops + self->columns;
+    self->tabstops = self->main_tabstops;
+    init_tabstops(self->main_tabstops, self->columns);
+    init_tabstops(self->alt_tabstops, self->columns);
+
+    // The GPU row cache is zeroed and marked as needing a full upload by ensure_gpu_rows()
+    self->gpu_rows.cells = a->gpu_rows;
+    self->gpu_rows.changed_rows = a->changed_rows;
+    self->gpu_rows.lines = 0; self->gpu_rows.columns = 0;
+
+    self->overlay_line.cpu_cells = a->overlay_cpu_cells;
+    self->overlay_line.gpu_cells = a->overlay_gpu_cells;
+    self->overlay_line.original_line.cpu_cells = a->original_cpu_cells;
+    self->overlay_line.original_line.gpu_cells = a->original_gpu_cells;
+    if (!keep_overlay_active) {
         self->overlay_line.is_active = false;
         self->overlay_line.xnum = 0;
     }
@@ -70,14 +113,12 @@ init_overlay_line(Screen *self, index_type columns, bool keep_active) {
     self->overlay_line.cursor_x = 0;
     self->overlay_line.last_ime_pos.x = 0;
     self->overlay_line.last_ime_pos.y = 0;
-
-    return true;
 }
 
 static void deactivate_overlay_line(Screen *self);
 static void update_overlay_position(Screen *self);
 static void render_overlay_line(Screen *self, Line *line, FONTS_DATA_HANDLE fonts_data);
-static void update_overlay_line_data(Screen *self, uint8_t *data);
+static void update_overlay_line_data(Screen *self);
 
 #define RESET_CHARSETS \
         self->g0_charset = translation_table(0); \
@@ -87,8 +128,11 @@ static void update_overlay_line_data(Screen *self, uint8_t *data);
         self->utf8_state = 0; \
         self->utf8_codepoint = 0; \
         self->use_latin1 = false;
+// Pending replies are flushed first as the callback may write to the child
+// directly and replies must reach it in the order they were generated
 #define CALLBACK(...) \
     if (self->callbacks != Py_None) { \
+        screen_flush_pending_replies(self); \
         PyObject *callback_ret = PyObject_CallMethod(self->callbacks, __VA_ARGS__); \
         if (callback_ret == NULL) PyErr_Print(); else Py_DECREF(callback_ret); \
     }
@@ -131,23 +175,19 @@ new(PyTypeObject *type, PyObject *args, PyObject UNUSED *kwds) {
         self->color_profile = alloc_color_profile();
         self->main_linebuf = alloc_linebuf(lines, columns); self->alt_linebuf = alloc_linebuf(lines, columns);
         self->linebuf = self->main_linebuf;
-        self->historybuf = alloc_historybuf(MAX(scrollback, lines), columns, OPT(scrollback_pager_history_size));
+        self->historybuf = alloc_historybuf(MAX(scrollback, lines), columns, OPT(scrollback_pager_history_size), OPT(scrollback_deduplicate));
 
         self->pending_mode.wait_time = s_double_to_monotonic_t(2.0);
-        self->main_tabstops = PyMem_Calloc(2 * self->columns, sizeof(bool));
         if (
             self->cursor == NULL || self->main_linebuf == NULL ||
-            self->alt_linebuf == NULL || self->main_tabstops == NULL
-            || self->historybuf == NULL || self->color_profile == NULL
+            self->alt_linebuf == NULL || self->historybuf == NULL || self->color_profile == NULL
         ) {
             Py_CLEAR(self); return NULL;
         }
-        self->alt_tabstops = self->main_tabstops + self->columns;
-        self->tabstops = self->main_tabstops;
-        init_tabstops(self->main_tabstops, self->columns);
-        init_tabstops(self->alt_tabstops, self->columns);
+        ScreenArena arena;
+        if (!alloc_screen_arena(&arena, self->lines, self->columns)) { Py_CLEAR(self); return NULL; }
+        use_screen_arena(self, &arena, false);
         self->key_encoding_flags = self->main_key_encoding_flags;
-        if (!init_overlay_line(self, self->columns, false)) { Py_CLEAR(self); return NULL; }
     }
     return (PyObject*) self;
 }
@@ -207,7 +247,7 @@ screen_dirty_sprite_positions(Screen *self) {
 
 static HistoryBuf*
 realloc_hb(HistoryBuf *old, unsigned int lines, unsigned int columns, ANSIBuf *as_ansi_buf) {
-    HistoryBuf *ans = alloc_historybuf(lines, columns, 0);
+    HistoryBuf *ans = alloc_historybuf(lines, columns, 0, old->deduplicate);
     if (ans == NULL) { PyErr_NoMemory(); return NULL; }
     ans->pagerhist = old->pagerhist; old->pagerhist = NULL;
     historybuf_rewrap(old, ans, as_ansi_buf);
@@ -345,16 +385,18 @@ screen_resize(Screen *self, unsigned int lines, unsigned int columns) {
     which.is_beyond_content = num_content_lines_before > 0 && self->cursor->y >= num_content_lines_before; \
     which.num_content_lines = num_content_lines_after; \
 }
-    // Resize overlay line
-    if (!init_overlay_line(self, columns, true)) return false;
+    // Allocate the arena for the new size up front, it replaces the current
+    // one only once the line buffers have been resized successfully
+    ScreenArena arena;
+    if (!alloc_screen_arena(&arena, lines, columns)) return false;
 
     // Resize main linebuf
     HistoryBuf *nh = realloc_hb(self->historybuf, self->historybuf->ynum, columns, &self->as_ansi_buf);
-    if (nh == NULL) return false;
+    if (nh == NULL) { PyMem_Free(arena.mem); return false; }
     Py_CLEAR(self->historybuf); self->historybuf = nh;
     if (is_main) prevent_current_prompt_from_rewrapping(self);
     LineBuf *n = realloc_lb(self->main_linebuf, lines, columns, &num_content_lines_before, &num_content_lines_after, self->historybuf, &cursor, &main_saved_cursor, &self->as_ansi_buf);
-    if (n == NULL) return false;
+    if (n == NULL) { PyMem_Free(arena.mem); return false; }
     Py_CLEAR(self->main_linebuf); self->main_linebuf = n;
     if (is_main) setup_cursor(cursor);
     /* printf("old_cursor: (%u, %u) new_cursor: (%u, %u) beyond_content: %d\n", self->cursor->x, self->cursor->y, cursor.after.x, cursor.after.y, cursor.is_beyond_content); */
@@ -362,7 +404,7 @@ screen_resize(Screen *self, unsigned int lines, unsigned int columns) {
 
     // Resize alt linebuf
     n = realloc_lb(self->alt_linebuf, lines, columns, &num_content_lines_before, &num_content_lines_after, NULL, &cursor, &alt_saved_cursor, &self->as_ansi_buf);
-    if (n == NULL) return false;
+    if (n == NULL) { PyMem_Free(arena.mem); return false; }
     Py_CLEAR(self->alt_linebuf); self->alt_linebuf = n;
     if (!is_main) setup_cursor(cursor);
     setup_cursor(alt_saved_cursor);
@@ -372,14 +414,7 @@ screen_resize(Screen *self, unsigned int lines, unsigned int columns) {
     /* printf("\nold_size: (%u, %u) new_size: (%u, %u)\n", self->columns, self->lines, columns, lines); */
     self->lines = lines; self->columns = columns;
     self->margin_top = 0; self->margin_bottom = self->lines - 1;
-
-    PyMem_Free(self->main_tabstops);
-    self->main_tabstops = PyMem_Calloc(2*self->columns, sizeof(bool));
-    if (self->main_tabstops == NULL) { PyErr_NoMemory(); return false; }
-    self->alt_tabstops = self->main_tabstops + self->columns;
-    self->tabstops = self->main_tabstops;
-    init_tabstops(self->main_tabstops, self->columns);
-    init_tabstops(self->alt_tabstops, self->columns);
+    use_screen_arena(self, &arena, true);
     self->is_dirty = true;
     clear_selection(&self->selections);
     self->last_visited_prompt.is_set = false;
@@ -433,13 +468,10 @@ dealloc(Screen* self) {
     Py_CLEAR(self->historybuf);
     Py_CLEAR(self->color_profile);
     Py_CLEAR(self->marker);
-    PyMem_Free(self->overlay_line.cpu_cells);
-    PyMem_Free(self->overlay_line.gpu_cells);
-    PyMem_Free(self->overlay_line.original_line.cpu_cells);
-    PyMem_Free(self->overlay_line.original_line.gpu_cells);
     Py_CLEAR(self->overlay_line.overlay_text);
-    PyMem_Free(self->main_tabstops);
+    PyMem_Free(self->arena);
     free(self->pending_mode.buf);
+    free(self->pending_replies.buf);
     free(self->selections.items);
     free(self->as_ansi_buf.buf);
     free(self->last_rendered_window_char.canvas);
@@ -722,15 +754,37 @@ write_to_test_child(Screen *self, const char *data, size_t sz) {
     PyObject *r = PyObject_CallMethod(self->test_child, "write", "y#", data, sz); if (r == NULL) PyErr_Print(); Py_CLEAR(r);
 }
 
+static void
+queue_reply(Screen *self, const char *data, size_t sz) {
+    ensure_space_for(&self->pending_replies, buf, char, self->pending_replies.used + sz, capacity, 256, false);
+    memcpy(self->pending_replies.buf + self->pending_replies.used, data, sz);
+    self->pending_replies.used += sz;
+}
+
+void
+screen_flush_pending_replies(Screen *self) {
+    if (self->pending_replies.used) {
+        if (self->window_id) schedule_write_to_child(self->window_id, 1, self->pending_replies.buf, self->pending_replies.used);
+        self->pending_replies.used = 0;
+        if (self->pending_replies.capacity > 64 * 1024) {
+            free(self->pending_replies.buf); self->pending_replies.buf = NULL;
+            self->pending_replies.capacity = 0;
+        }
+    }
+}
+
 static bool
 write_to_child(Screen *self, const char *data, size_t sz) {
     bool written = false;
-    if (self->window_id) written = schedule_write_to_child(self->window_id, 1, data, sz);
+    if (self->window_id) {
+        if (self->pending_replies.batching) { queue_reply(self, data, sz); written = true; }
+        else written = schedule_write_to_child(self->window_id, 1, data, sz);
+    }
     if (self->test_child != Py_None) { write_to_test_child(self, data, sz); }
     return written;
 }
 
-static void
+void
 get_prefix_and_suffix_for_escape_code(const Screen *self, unsigned char which, const char ** prefix, const char ** suffix) {
     *suffix = self->modes.eight_bit_controls ? "\x9c" : "\033\\";
     switch(which) {
@@ -759,17 +813,22 @@ write_escape_code_to_child(Screen *self, unsigned char which, const char *data)
     bool written = false;
     const char *prefix, *suffix;
     get_prefix_and_suffix_for_escape_code(self, which, &prefix, &suffix);
+    const size_t prefix_sz = strlen(prefix), data_sz = strlen(data), suffix_sz = strlen(suffix);
     if (self->window_id) {
-        if (suffix[0]) {
-            written = schedule_write_to_child(self->window_id, 3, prefix, strlen(prefix), data, strlen(data), suffix, strlen(suffix));
+        if (self->pending_replies.batching) {
+            queue_reply(self, prefix, prefix_sz); queue_reply(self, data, data_sz);
+            if (suffix_sz) queue_reply(self, suffix, suffix_sz);
+            written = true;
+        } else if (suffix_sz) {
+            written = schedule_write_to_child(self->window_id, 3, prefix, prefix_sz, data, data_sz, suffix, suffix_sz);
         } else {
-            written = schedule_write_to_child(self->window_id, 2, prefix, strlen(prefix), data, strlen(data));
+            written = schedule_write_to_child(self->window_id, 2, prefix, prefix_sz, data, data_sz);
         }
     }
     if (self->test_child != Py_None) {
-        write_to_test_child(self, prefix, strlen(prefix));
-        write_to_test_child(self, data, strlen(data));
-        if (suffix[0]) write_to_test_child(self, suffix, strlen(suffix));
+        write_to_test_child(self, prefix, prefix_sz);
+        write_to_test_child(self, data, data_sz);
+        if (suffix_sz) write_to_test_child(self, suffix, suffix_sz);
     }
     return written;
 }
@@ -779,6 +838,7 @@ write_escape_code_to_child_python(Screen *self, unsigned char which, PyObject *d
     bool written = false;
     const char *prefix, *suffix;
     get_prefix_and_suffix_for_escape_code(self, which, &prefix, &suffix);
+    screen_flush_pending_replies(self);
     if (self->window_id) written = schedule_write_to_child_python(self->window_id, prefix, data, suffix);
     if (self->test_child != Py_None) {
         write_to_test_child(self, prefix, strlen(prefix));
@@ -1304,6 +1364,7 @@ screen_cursor_to_column(Screen *self, unsigned int column) {
         } \
     } \
     linebuf_clear_line(self->linebuf, bottom, true); \
+    if (top == 0 && bottom == self->lines - 1) self->gpu_rows.pending_scroll++; \
     self->is_dirty = true; \
     index_selection(self, &self->selections, true);
 
@@ -1316,14 +1377,39 @@ screen_index(Screen *self) {
     } else screen_cursor_down(self, 1);
 }
 
+static void
+index_up_lines(Screen *self, unsigned int top, unsigned int bottom, unsigned int count) {
+    // The same as running INDEX_UP count times, but the lines are moved with a single rotation
+    if (!count) return;
+    if (count == 1 || bottom <= top) {
+        while (count-- > 0) { INDEX_UP; }
+        return;
+    }
+    const unsigned int num = MIN(count, bottom - top + 1);
+    if (self->linebuf == self->main_linebuf && self->margin_top == 0) {
+        // Lines scrolled off the top go into history in order, once the region is
+        // exhausted the blank lines that would have scrolled off follow them
+        for (unsigned int i = 0; i < count; i++) {
+            if (i == num) linebuf_clear_line(self->linebuf, bottom, true);
+            linebuf_init_line(self->linebuf, i < num ? top + i : bottom);
+            historybuf_add_line(self->historybuf, self->linebuf->line, &self->as_ansi_buf);
+            self->history_line_added_count++;
+            if (self->last_visited_prompt.is_set) {
+                if (self->last_visited_prompt.scrolled_by < self->historybuf->count) self->last_visited_prompt.scrolled_by++;
+                else self->last_visited_prompt.is_set = false;
+            }
+        }
+    }
+    linebuf_delete_lines(self->linebuf, num, top, bottom);
+    if (top == 0 && bottom == self->lines - 1) self->gpu_rows.pending_scroll += count;
+    self->is_dirty = true;
+    for (unsigned int i = 0; i < count; i++) index_selection(self, &self->selections, true);
+}
+
 void
 screen_scroll(Screen *self, unsigned int count) {
     // Scroll the screen up by count lines, not moving the cursor
-    unsigned int top = self->margin_top, bottom = self->margin_bottom;
-    while (count > 0) {
-        count--;
-        INDEX_UP;
-    }
+    index_up_lines(self, self->margin_top, self->margin_bottom, count);
 }
 
 void
@@ -1344,12 +1430,36 @@ _reverse_scroll(Screen *self, unsigned int count, bool fill_from_scrollback) {
         unsigned limit = MAX(self->lines, self->historybuf->count);
         count = MIN(limit, count);
     } else count = MIN(self->lines, count);
-    while (count-- > 0) {
-        bool copied = false;
-        if (fill_from_scrollback) copied = historybuf_pop_line(self->historybuf, self->alt_linebuf->line);
-        INDEX_DOWN;
-        if (copied) linebuf_copy_line_to(self->main_linebuf, self->alt_linebuf->line, 0);
+    if (count < 2 || bottom <= top || (fill_from_scrollback && top != 0)) {
+        while (count-- > 0) {
+            bool copied = false;
+            if (fill_from_scrollback) copied = historybuf_pop_line(self->historybuf, self->alt_linebuf->line);
+            INDEX_DOWN;
+            if (copied) linebuf_copy_line_to(self->main_linebuf, self->alt_linebuf->line, 0);
+        }
+        return;
+    }
+    // Move all lines with a single rotation. Filled lines end up in the same
+    // order as with one line at a time, lines that would have been pushed past
+    // the bottom of the region are dropped.
+    const unsigned int num = MIN(count, bottom - top + 1);
+    linebuf_insert_lines(self->linebuf, num, top, bottom);
+    if (fill_from_scrollback) {
+        for (unsigned int i = num; i < count; i++) historybuf_pop_line(self->historybuf, self->alt_linebuf->line);
+        for (unsigned int y = num; y-- > 0;) {
+            if (!historybuf_pop_line(self->historybuf, self->alt_linebuf->line)) break;
+            linebuf_copy_line_to(self->main_linebuf, self->alt_linebuf->line, y);
+        }
     }
+    for (unsigned int i = 0; i < count; i++) {
+        if (self->linebuf == self->main_linebuf && self->last_visited_prompt.is_set) {
+            if (self->last_visited_prompt.scrolled_by > 0) self->last_visited_prompt.scrolled_by--;
+            else if(self->last_visited_prompt.y < self->lines - 1) self->last_visited_prompt.y++;
+            else self->last_visited_prompt.is_set = false;
+        }
+        index_selection(self, &self->selections, false);
+    }
+    self->is_dirty = true;
 }
 
 void
@@ -1669,7 +1779,7 @@ screen_scroll_until_cursor_prompt(Screen *self) {
     unsigned int num_lines_to_scroll = MIN(self->margin_bottom, y);
     unsigned int final_y = num_lines_to_scroll <= self->cursor->y ? self->cursor->y - num_lines_to_scroll : 0;
     self->cursor->y = self->margin_bottom;
-    while (num_lines_to_scroll--) screen_index(self);
+    index_up_lines(self, self->margin_top, self->margin_bottom, num_lines_to_scroll);
     self->cursor->y = final_y;
     screen_ensure_bounds(self, false, in_margins);
 }
@@ -1704,10 +1814,45 @@ screen_insert_characters(Screen *self, unsigned int count) {
 
 void
 screen_repeat_character(Screen *self, unsigned int count) {
-    if (self->last_graphic_char) {
-        if (count == 0) count = 1;
-        unsigned int num = MIN(count, CSI_REP_MAX_REPETITIONS);
-        while (num-- > 0) screen_draw(self, self->last_graphic_char, false);
+    if (!self->last_graphic_char) return;
+    if (count == 0) count = 1;
+    unsigned int num = MIN(count, CSI_REP_MAX_REPETITIONS);
+    const char_type och = self->last_graphic_char;
+    // The first copy goes through the normal path, which takes care of activity tracking, wrapping, etc.
+    draw_codepoint(self, och, false); num--;
+    if (!num || is_ignored_char(och)) return;
+    const char_type ch = och < 256 ? self->g_charset[och] : och;
+    if (is_combining_char(ch) || self->modes.mIRM) {
+        while (num-- > 0) draw_codepoint(self, och, false);
+        return;
+    }
+    int w = wcwidth_std(ch);
+    if (w < 1) {
+        if (w == 0) return;
+        w = 1;
+    }
+    const index_type char_width = w;
+    while (num) {
+        if (self->columns - self->cursor->x < char_width) {
+            // without auto-wrap every further copy overwrites the last cell
+            if (!self->modes.mDECAWM) num = 1;
+            draw_codepoint(self, och, false); num--;
+            continue;
+        }
+        // fill as many copies as fit on this line by copying the first cell
+        const index_type x = self->cursor->x, n = MIN(num, (self->columns - x) / char_width);
+        linebuf_init_line(self->linebuf, self->cursor->y);
+        Line *line = self->linebuf->line;
+        line_set_char(line, x, ch, char_width, self->cursor);
+        if (char_width == 2) line_set_char(line, x + 1, 0, 0, self->cursor);
+        for (index_type i = x + char_width; i < x + n * char_width; i++) {
+            line->cpu_cells[i] = line->cpu_cells[i - char_width];
+            line->gpu_cells[i] = line->gpu_cells[i - char_width];
+        }
+        self->cursor->x += n * char_width; num -= n;
+        self->is_dirty = true;
+        if (selection_has_screen_line(&self->selections, self->cursor->y)) clear_selection(&self->selections);
+        linebuf_mark_line_dirty(self->linebuf, self->cursor->y);
     }
 }
 
@@ -2079,10 +2224,41 @@ get_line_edge_colors(Screen *self, color_type *left, color_type *right) {
 }
 
 
+static index_type
+gpu_row_for(const Screen *self, index_type y) {
+    return (y + self->gpu_rows.row_offset) % self->gpu_rows.lines;
+}
+
+static void
+update_line_data(Screen *self, const GPUCell *cells, index_type dest_y) {
+    // Only rows whose contents actually differ from what the GPU has are marked for upload
+    const index_type row = gpu_row_for(self, dest_y);
+    GPUCell *dest = self->gpu_rows.cells + (size_t)row * self->columns;
+    const size_t sz = self->columns * sizeof(GPUCell);
+    if (memcmp(dest, cells, sz) != 0) {
+        memcpy(dest, cells, sz);
+        self->gpu_rows.changed_rows[row] = true;
+    }
+}
+
+static bool
+ensure_gpu_rows(Screen *self) {
+    // Returns true if the GPU row cache was (re)allocated, in which case it must be uploaded in full.
+    // The cache itself lives in the screen arena, see use_screen_arena()
+    if (self->gpu_rows.lines == self->lines && self->gpu_rows.columns == self->columns) return false;
+    self->gpu_rows.lines = self->lines; self->gpu_rows.columns = self->columns;
+    self->gpu_rows.row_offset = 0; self->gpu_rows.pending_scroll = 0;
+    return true;
+}
+
 static void
-update_line_data(Line *line, unsigned int dest_y, uint8_t *data) {
-    size_t base = sizeof(GPUCell) * dest_y * line->xnum;
-    memcpy(data + base, line->gpu_cells, line->xnum * sizeof(GPUCell));
+shift_gpu_rows(Screen *self, bool reallocated) {
+    // Scrolling the whole screen up by n moves screen row y + n to row y, which
+    // for the ring of GPU rows is just an increase of the offset by n
+    const unsigned int n = self->gpu_rows.pending_scroll;
+    self->gpu_rows.pending_scroll = 0;
+    if (reallocated || !n || n >= self->lines || self->scrolled_by || self->last_rendered.scrolled_by) return;
+    self->gpu_rows.row_offset = (self->gpu_rows.row_offset + n) % self->lines;
 }
 
 
@@ -2097,24 +2273,27 @@ screen_has_marker(Screen *self) {
     return self->marker != NULL;
 }
 
-void
-screen_update_cell_data(Screen *self, void *address, FONTS_DATA_HANDLE fonts_data, bool cursor_has_moved) {
+bool
+screen_update_cell_data(Screen *self, FONTS_DATA_HANDLE fonts_data, bool cursor_has_moved) {
     const bool is_overlay_active = screen_is_overlay_active(self);
     unsigned int history_line_added_count = self->history_line_added_count;
     index_type lnum;
+    const bool reallocated = ensure_gpu_rows(self);
     screen_reset_dirty(self);
     update_overlay_position(self);
     if (self->scrolled_by) self->scrolled_by = MIN(self->scrolled_by + history_line_added_count, self->historybuf->count);
     self->scroll_changed = false;
+    shift_gpu_rows(self, reallocated);
     for (index_type y = 0; y < MIN(self->lines, self->scrolled_by); y++) {
         lnum = self->scrolled_by - 1 - y;
         historybuf_init_line(self->historybuf, lnum, self->historybuf->line);
         if (self->historybuf->line->attrs.has_dirty_text) {
+            historybuf_init_line_for_rendering(self->historybuf, lnum, self->historybuf->line);
             render_line(fonts_data, self->historybuf->line, self->cursor);
             if (screen_has_marker(self)) mark_text_in_line(self->marker, self->historybuf->line);
-            historybuf_mark_line_clean(self->historybuf, lnum);
+            historybuf_finish_rendering_line(self->historybuf, lnum, self->historybuf->line);
         }
-        update_line_data(self->historybuf->line, y, address);
+        update_line_data(self, self->historybuf->line->gpu_cells, y);
     }
     for (index_type y = self->scrolled_by; y < self->lines; y++) {
         lnum = y - self->scrolled_by;
@@ -2126,15 +2305,16 @@ screen_update_cell_data(Screen *self, void *address, FONTS_DATA_HANDLE fonts_dat
             if (is_overlay_active && lnum == self->overlay_line.ynum) render_overlay_line(self, self->linebuf->line, fonts_data);
             linebuf_mark_line_clean(self->linebuf, lnum);
         }
-        update_line_data(self->linebuf->line, y, address);
+        update_line_data(self, self->linebuf->line->gpu_cells, y);
     }
     if (is_overlay_active && self->overlay_line.ynum + self->scrolled_by < self->lines) {
         if (self->overlay_line.is_dirty) {
             linebuf_init_line(self->linebuf, self->overlay_line.ynum);
             render_overlay_line(self, self->linebuf->line, fonts_data);
         }
-        update_overlay_line_data(self, address);
+        update_overlay_line_data(self);
     }
+    return reallocated;
 }
 
 static bool
@@ -2318,7 +2498,7 @@ apply_selection(Screen *self, uint8_t *data, Selection *s, uint8_t set_mask) {
 
     for (int y = MAX(0, s->last_rendered.y); y < s->last_rendered.y_limit && y < (int)self->lines; y++) {
         Line *line = visual_line_(self, y);
-        uint8_t *line_start = data + self->columns * y;
+        uint8_t *line_start = data + self->columns * gpu_row_for(self, y);
         XRange xr = xrange_for_iteration(&s->last_rendered, y, line);
         for (index_type x = xr.x; x < xr.x_limit; x++) line_start[x] |= set_mask;
     }
@@ -2341,10 +2521,12 @@ screen_has_selection(Screen *self) {
 void
 screen_apply_selection(Screen *self, void *address, size_t size) {
     memset(address, 0, size);
+    ensure_gpu_rows(self);
     for (size_t i = 0; i < self->selections.count; i++) {
         apply_selection(self, address, self->selections.items + i, 1);
     }
     self->selections.last_rendered_count = self->selections.count;
+    self->gpu_rows.selection_row_offset = self->gpu_rows.row_offset;
 }
 
 static index_type
@@ -2597,9 +2779,8 @@ render_overlay_line(Screen *self, Line *line, FONTS_DATA_HANDLE fonts_data) {
 }
 
 static void
-update_overlay_line_data(Screen *self, uint8_t *data) {
-    const size_t base = sizeof(GPUCell) * (self->overlay_line.ynum + self->scrolled_by) * self->columns;
-    memcpy(data + base, self->overlay_line.gpu_cells, self->columns * sizeof(GPUCell));
+update_overlay_line_data(Screen *self) {
+    update_line_data(self, self->overlay_line.gpu_cells, self->overlay_line.ynum + self->scrolled_by);
 }
 
 // }}}
@@ -3211,6 +3392,7 @@ bool
 screen_is_selection_dirty(Screen *self) {
     IterationData q;
     if (self->scrolled_by != self->last_rendered.scrolled_by) return true;
+    if (self->gpu_rows.row_offset != self->gpu_rows.selection_row_offset) return true;
     if (self->selections.last_rendered_count != self->selections.count) return true;
     for (size_t i = 0; i < self->selections.count; i++) {
         iteration_data(self, self->selections.items + i, &q, 0, true);
@@ -101,6 +101,15 @@ typedef struct {
         index_type lines, columns;
     } last_rendered;
     bool use_latin1, is_dirty, scroll_changed, reload_all_gpu_data;
+    struct {
+        // Copy of the cell data last uploaded to the GPU. Rows are stored as a ring
+        // starting at row_offset so that scrolling the whole screen only moves the
+        // offset and just the newly exposed rows need to be uploaded.
+        GPUCell *cells;
+        bool *changed_rows;
+        index_type lines, columns, row_offset, selection_row_offset;
+        unsigned int pending_scroll;
+    } gpu_rows;
     Cursor *cursor;
     Savepoint main_savepoint, alt_savepoint;
     PyObject *callbacks, *test_child;
@@ -108,6 +117,8 @@ typedef struct {
     HistoryBuf *historybuf;
     unsigned int history_line_added_count;
     bool *tabstops, *main_tabstops, *alt_tabstops;
+    // Single allocation backing the tabstops, the overlay line cells and the GPU row cache
+    void *arena;
     ScreenModes modes;
     ColorProfile *color_profile;
 
@@ -115,7 +126,7 @@ typedef struct {
     unsigned int parser_state, parser_text_start, parser_buf_pos;
     bool parser_has_pending_text;
     uint8_t read_buf[READ_BUF_SZ], *write_buf;
-    monotonic_t new_input_at;
+    monotonic_t new_input_at, last_key_input_at;
     size_t read_buf_sz, write_buf_sz, write_buf_used;
     pthread_mutex_t read_buf_lock, write_buf_lock;
 
@@ -128,6 +139,13 @@ typedef struct {
         monotonic_t activated_at, wait_time;
         unsigned stop_escape_code_type;
     } pending_mode;
+    struct {
+        // Replies to the child generated while batching is set are collected
+        // here and sent with a single write at the end of the parse pass
+        char *buf;
+        size_t capacity, used;
+        bool batching;
+    } pending_replies;
     PyObject *marker;
     bool has_focus;
     bool has_activity_since_last_focus;
@@ -157,12 +175,14 @@ typedef struct {
 } Screen;
 
 
-void parse_worker(Screen *screen, PyObject *dump_callback, monotonic_t now);
-void parse_worker_dump(Screen *screen, PyObject *dump_callback, monotonic_t now);
+void parse_worker(Screen *screen, PyObject *dump_callback, monotonic_t now, monotonic_t deadline);
+void parse_worker_dump(Screen *screen, PyObject *dump_callback, monotonic_t now, monotonic_t deadline);
 void screen_align(Screen*);
 void screen_restore_cursor(Screen *);
 void screen_save_cursor(Screen *);
+void get_prefix_and_suffix_for_escape_code(const Screen *self, unsigned char which, const char **prefix, const char **suffix);
 bool write_escape_code_to_child(Screen *self, unsigned char which, const char *data);
+void screen_flush_pending_replies(Screen *self);
 void screen_cursor_position(Screen*, unsigned int, unsigned int);
 void screen_cursor_back(Screen *self, unsigned int count/*=1*/, int move_direction/*=-1*/);
 void screen_erase_in_line(Screen *, unsigned int, bool);
@@ -228,7 +248,7 @@ void screen_apply_selection(Screen *self, void *address, size_t size);
 bool screen_is_selection_dirty(Screen *self);
 bool screen_has_selection(Screen*);
 bool screen_invert_colors(Screen *self);
-void screen_update_cell_data(Screen *self, void *address, FONTS_DATA_HANDLE, bool cursor_has_moved);
+bool screen_update_cell_data(Screen *self, FONTS_DATA_HANDLE, bool cursor_has_moved);
 bool screen_is_cursor_visible(const Screen *self);
 bool screen_selection_range_for_line(Screen *self, index_type y, index_type *start, index_type *end);
 bool screen_selection_range_for_word(Screen *self, const index_type x, const index_type y, index_type *, index_type *, index_type *start, index_type *end, bool);
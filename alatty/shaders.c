@@ -22,12 +22,14 @@ enum { SPRITE_MAP_UNIT, GRAPHICS_UNIT, BGIMAGE_UNIT };
 // Sprites {{{
 typedef struct {
     unsigned int cell_width, cell_height;
-    int xnum, ynum, x, y, z, last_num_of_layers, last_ynum;
+    int xnum, ynum, x, y, z;
+    // The size of the texture, which can be larger than the space used by sprites
+    unsigned int allocated_ynum, allocated_layers;
     GLuint texture_id;
     GLint max_texture_size, max_array_texture_layers;
 } SpriteMap;
 
-static const SpriteMap NEW_SPRITE_MAP = { .xnum = 1, .ynum = 1, .last_num_of_layers = 1, .last_ynum = -1 };
+static const SpriteMap NEW_SPRITE_MAP = { .xnum = 1, .ynum = 1 };
 static GLint max_texture_size = 0, max_array_texture_layers = 0;
 
 static GLfloat
@@ -93,7 +95,7 @@ copy_image_sub_data(GLuint src_texture_id, GLuint dest_texture_id, unsigned int
 
 
 static void
-realloc_sprite_texture(FONTS_DATA_HANDLE fg) {
+realloc_sprite_texture(FONTS_DATA_HANDLE fg, unsigned int ynum, unsigned int num_layers) {
     GLuint tex;
     glGenTextures(1, &tex);
     glBindTexture(GL_TEXTURE_2D_ARRAY, tex);
@@ -103,28 +105,33 @@ realloc_sprite_texture(FONTS_DATA_HANDLE fg) {
     glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    unsigned int xnum, ynum, z, znum, width, height, src_ynum;
-    sprite_tracker_current_layout(fg, &xnum, &ynum, &z);
-    znum = z + 1;
+    unsigned int xnum, used_ynum, z, width, height;
+    sprite_tracker_current_layout(fg, &xnum, &used_ynum, &z);
     SpriteMap *sprite_map = (SpriteMap*)fg->sprite_map;
     width = xnum * sprite_map->cell_width; height = ynum * sprite_map->cell_height;
-    glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_SRGB8_ALPHA8, width, height, znum);
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_SRGB8_ALPHA8, width, height, num_layers);
     if (sprite_map->texture_id) {
         // need to re-alloc
-        src_ynum = MAX(1, sprite_map->last_ynum);
-        copy_image_sub_data(sprite_map->texture_id, tex, width, src_ynum * sprite_map->cell_height, sprite_map->last_num_of_layers);
+        copy_image_sub_data(sprite_map->texture_id, tex, width, sprite_map->allocated_ynum * sprite_map->cell_height, sprite_map->allocated_layers);
         glDeleteTextures(1, &sprite_map->texture_id);
     }
     glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
-    sprite_map->last_num_of_layers = znum;
-    sprite_map->last_ynum = ynum;
+    sprite_map->allocated_layers = num_layers;
+    sprite_map->allocated_ynum = ynum;
     sprite_map->texture_id = tex;
 }
 
+static void
+ensure_sprite_texture_size(FONTS_DATA_HANDLE fg) {
+    SpriteMap *sprite_map = (SpriteMap*)fg->sprite_map;
+    unsigned int ynum = sprite_map->allocated_ynum, num_layers = sprite_map->allocated_layers;
+    if (sprite_tracker_texture_size(fg, &ynum, &num_layers)) realloc_sprite_texture(fg, ynum, num_layers);
+}
+
 static void
 ensure_sprite_map(FONTS_DATA_HANDLE fg) {
     SpriteMap *sprite_map = (SpriteMap*)fg->sprite_map;
-    if (!sprite_map->texture_id) realloc_sprite_texture(fg);
+    if (!sprite_map->texture_id) ensure_sprite_texture_size(fg);
     // We have to rebind since we don't know if the texture was ever bound
     // in the context of the current OSWindow
     glActiveTexture(GL_TEXTURE0 + SPRITE_MAP_UNIT);
@@ -134,9 +141,7 @@ ensure_sprite_map(FONTS_DATA_HANDLE fg) {
 void
 send_sprite_to_gpu(FONTS_DATA_HANDLE fg, unsigned int x, unsigned int y, unsigned int z, pixel *buf) {
     SpriteMap *sprite_map = (SpriteMap*)fg->sprite_map;
-    unsigned int xnum, ynum, znum;
-    sprite_tracker_current_layout(fg, &xnum, &ynum, &znum);
-    if ((int)znum >= sprite_map->last_num_of_layers || (znum == 0 && (int)ynum > sprite_map->last_ynum)) realloc_sprite_texture(fg);
+    ensure_sprite_texture_size(fg);
     glBindTexture(GL_TEXTURE_2D_ARRAY, sprite_map->texture_id);
     glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
     x *= sprite_map->cell_width; y *= sprite_map->cell_height;
@@ -231,7 +236,7 @@ cell_update_uniform_block(ssize_t vao_idx, Screen *screen, int uniform_buffer, c
 
         GLuint default_fg, default_bg, highlight_fg, highlight_bg, cursor_fg, cursor_bg, inverted;
 
-        GLuint xnum, ynum, cursor_fg_sprite_idx;
+        GLuint xnum, ynum, row_offset, cursor_fg_sprite_idx;
         GLfloat cursor_x, cursor_y, cursor_w;
     };
     // Send the uniform data
@@ -293,11 +298,14 @@ cell_update_uniform_block(ssize_t vao_idx, Screen *screen, int uniform_buffer, c
             screen_current_char_width(screen) > 1
     ) rd->cursor_w += 1;
 
-    rd->xnum = screen->columns; rd->ynum = screen->lines;
+    rd->xnum = screen->columns; rd->ynum = screen->lines; rd->row_offset = screen->gpu_rows.row_offset;
 
     rd->xstart = crd->gl.xstart; rd->ystart = crd->gl.ystart; rd->dx = crd->gl.dx; rd->dy = crd->gl.dy;
     unsigned int x, y, z;
     sprite_tracker_current_layout(os_window->fonts_data, &x, &y, &z);
+    // The texture can have more rows than are in use, see ensure_sprite_texture_size()
+    const SpriteMap *sprite_map = (const SpriteMap*)os_window->fonts_data->sprite_map;
+    if (sprite_map->allocated_ynum > y) y = sprite_map->allocated_ynum;
     rd->sprite_dx = 1.0f / (float)x; rd->sprite_dy = 1.0f / (float)y;
     rd->inverted = inverted ? 1 : 0;
     rd->background_opacity = os_window->is_semi_transparent ? os_window->background_opacity : 1.0f;
@@ -321,10 +329,19 @@ cell_prepare_to_render(ssize_t vao_idx, Screen *screen, FONTS_DATA_HANDLE fonts_
     bool screen_resized = screen->last_rendered.columns != screen->columns || screen->last_rendered.lines != screen->lines;
 
     if (screen->reload_all_gpu_data || screen->scroll_changed || screen->is_dirty || screen_resized || cursor_pos_changed) {
-        sz = sizeof(GPUCell) * screen->lines * screen->columns;
-        address = alloc_and_map_vao_buffer(vao_idx, sz, cell_data_buffer, GL_STREAM_DRAW, GL_WRITE_ONLY);
-        screen_update_cell_data(screen, address, fonts_data, cursor_pos_changed);
-        unmap_vao_buffer(vao_idx, cell_data_buffer); address = NULL;
+        const size_t row_sz = sizeof(GPUCell) * screen->columns;
+        sz = row_sz * screen->lines;
+        alloc_vao_buffer(vao_idx, sz, cell_data_buffer, GL_STREAM_DRAW);
+        const bool upload_all = screen_update_cell_data(screen, fonts_data, cursor_pos_changed) || screen->reload_all_gpu_data || screen_resized;
+        bool *changed_rows = screen->gpu_rows.changed_rows;
+        // upload only the runs of rows whose contents changed
+        for (index_type y = 0; y < screen->lines;) {
+            if (!changed_rows[y] && !upload_all) { y++; continue; }
+            index_type limit = y;
+            while (limit < screen->lines && (changed_rows[limit] || upload_all)) changed_rows[limit++] = false;
+            update_vao_buffer(vao_idx, cell_data_buffer, row_sz * y, row_sz * (limit - y), (uint8_t*)screen->gpu_rows.cells + row_sz * y);
+            y = limit;
+        }
         changed = true;
     }
 
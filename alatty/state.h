@@ -46,7 +46,7 @@ typedef struct {
   float cursor_beam_thickness;
   float cursor_underline_thickness;
   unsigned int scrollback_pager_history_size;
-  bool scrollback_fill_enlarged_window;
+  bool scrollback_fill_enlarged_window, scrollback_deduplicate;
   char_type *select_by_word_characters;
   char_type *select_by_word_characters_forward;
   color_type background, foreground, active_border_color,
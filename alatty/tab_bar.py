@@ -331,6 +331,7 @@ def __init__(self, os_window_id: int):
         self.blank_rects: Tuple[Border, ...] = ()
         self.cell_ranges: List[Tuple[int, int]] = []
         self.laid_out_once = False
+        self.last_drawn_data: Sequence[TabBarData] = ()
         self.apply_options()
 
     def apply_options(self) -> None:
@@ -369,6 +370,9 @@ def apply_options(self) -> None:
             'top' if opts.tab_bar_edge == 1 else 'bottom',
             opts.tab_title_max_length,
         )
+        # Templates can read state through TabAccessor, such as the working
+        # directory of the active window, which is not part of TabBarData
+        self.templates_use_tab_accessor = 'tab.' in opts.tab_title_template or 'tab.' in (opts.active_tab_title_template or '')
         ts = opts.tab_bar_style
         if ts == 'custom':
             self.draw_func = load_custom_draw_tab()
@@ -423,6 +427,7 @@ def layout(self) -> None:
         s.resize(1, ncells)
         s.reset_mode(DECAWM)
         self.laid_out_once = True
+        self.dirty = True
         margin = (viewport_width - ncells * cell_width) // 2 + self.margin_width
         self.window_geometry = g = WindowGeometry(
             margin, tab_bar.top, viewport_width - margin, tab_bar.bottom, s.columns, s.lines)
@@ -432,6 +437,17 @@ def layout(self) -> None:
     def update(self, data: Sequence[TabBarData]) -> None:
         if not self.laid_out_once:
             return
+        # Titles are often re-set to the same value (for example by shells on
+        # every prompt), so skip redrawing when nothing visible has changed.
+        # Custom draw functions and templates that use the tab accessor may draw
+        # things not in data, so always call them.
+        if (
+            not self.dirty and self.draw_func is draw_tab_with_separator and not self.templates_use_tab_accessor
+            and data == self.last_drawn_data
+        ):
+            return
+        self.dirty = False
+        self.last_drawn_data = tuple(data)
         s = self.screen
         last_tab = data[-1] if data else None
         ed = ExtraData()
@@ -5,7 +5,7 @@
 import stat
 import weakref
 from collections import deque
-from contextlib import suppress
+from contextlib import contextmanager, suppress
 from operator import attrgetter
 from typing import (
     Any,
@@ -125,6 +125,8 @@ def __init__(
         self.windows: WindowList = WindowList(self)
         self._last_used_layout: Optional[str] = None
         self._current_layout_name: Optional[str] = None
+        self.relayout_batch_depth = 0
+        self.relayout_pending = self.relayout_borders_pending = False
         self.cwd = self.args.directory
         if no_initial_window:
             self._set_current_layout(self.enabled_layouts[0])
@@ -173,11 +175,12 @@ def take_over_from(self, other_tab: 'Tab') -> None:
         self.windows = other_tab.windows
         self.windows.change_tab(self)
         other_tab.windows = WindowList(other_tab)
-        for window in self.windows:
-            window.change_tab(self)
-            attach_window(self.os_window_id, self.id, window.id)
-        self.active_window_changed()
-        self.relayout()
+        with self.batched_relayout():
+            for window in self.windows:
+                window.change_tab(self)
+                attach_window(self.os_window_id, self.id, window.id)
+            self.active_window_changed()
+            self.relayout()
 
     def _set_current_layout(self, layout_name: str) -> None:
         self._last_used_layout = self._current_layout_name
@@ -186,17 +189,18 @@ def _set_current_layout(self, layout_name: str) -> None:
         self.mark_tab_bar_dirty()
 
     def startup(self, session_tab: 'SessionTab') -> None:
-        for window in session_tab.windows:
-            spec = window.launch_spec
-            if isinstance(spec, SpecialWindowInstance):
-                self.new_special_window(spec)
-            else:
-                from .launch import launch
-                launch(get_boss(), spec.opts, spec.args, target_tab=self, force_target_tab=True)
-            if window.resize_spec is not None:
-                self.resize_window(*window.resize_spec)
+        with self.batched_relayout():
+            for window in session_tab.windows:
+                spec = window.launch_spec
+                if isinstance(spec, SpecialWindowInstance):
+                    self.new_special_window(spec)
+                else:
+                    from .launch import launch
+                    launch(get_boss(), spec.opts, spec.args, target_tab=self, force_target_tab=True)
+                if window.resize_spec is not None:
+                    self.resize_window(*window.resize_spec)
 
-        self.windows.set_active_window_group_for(self.windows.all_windows[session_tab.active_window_idx])
+            self.windows.set_active_window_group_for(self.windows.all_windows[session_tab.active_window_idx])
 
     def active_window_changed(self) -> None:
         w = self.active_window
@@ -253,12 +257,35 @@ def title_changed(self, window: Window) -> None:
             if tm is not None:
                 tm.title_changed()
 
+    @contextmanager
+    def batched_relayout(self) -> Iterator[None]:
+        ''' Defer relayouts requested inside the block to a single relayout at its end,
+        so that adding or removing many windows lays out and resizes each window only once. '''
+        self.relayout_batch_depth += 1
+        try:
+            yield
+        finally:
+            self.relayout_batch_depth -= 1
+            if not self.relayout_batch_depth:
+                if self.relayout_pending:
+                    self.relayout()
+                elif self.relayout_borders_pending:
+                    self.relayout_borders()
+
     def relayout(self) -> None:
+        if self.relayout_batch_depth:
+            self.relayout_pending = True
+            return
+        self.relayout_pending = False
         if self.windows:
             self.current_layout(self.windows)
         self.relayout_borders()
 
     def relayout_borders(self) -> None:
+        if self.relayout_batch_depth:
+            self.relayout_borders_pending = True
+            return
+        self.relayout_borders_pending = False
         tm = self.tab_manager_ref()
         if tm is not None:
             ly = self.current_layout
@@ -499,8 +526,9 @@ def remove_window(self, window: Window, destroy: bool = True) -> None:
     def detach_window(self, window: Window) -> Tuple[Window, ...]:
         windows = list(self.windows.windows_in_group_of(window))
         windows.sort(key=attrgetter('id'))  # since ids increase in order of creation
-        for w in reversed(windows):
-            self.remove_window(w, destroy=False)
+        with self.batched_relayout():
+            for w in reversed(windows):
+                self.remove_window(w, destroy=False)
         return tuple(windows)
 
     def attach_window(self, window: Window) -> None:
@@ -704,6 +732,11 @@ def mark_tab_bar_dirty(self) -> None:
     def update_tab_bar_data(self) -> None:
         self.tab_bar.update(self.tab_bar_data)
 
+    def invalidate_tab_bar(self) -> None:
+        # Force a redraw on the next frame even if the tab data is unchanged
+        self.tab_bar.dirty = True
+        self.mark_tab_bar_dirty()
+
     def title_changed(self) -> None:
         self.mark_tab_bar_dirty()
 
@@ -930,7 +963,6 @@ def apply_options(self) -> None:
             tab.apply_options(at is tab)
         self.tab_bar_hidden = get_options().tab_bar_style == 'hidden'
         self.tab_bar.apply_options()
-        self.update_tab_bar_data()
-        self.mark_tab_bar_dirty()
+        self.invalidate_tab_bar()
         self.tab_bar.layout()
 # }}}
@@ -680,16 +680,6 @@ def less_version(less_exe: str = 'less') -> int:
     return int(m.group(1))
 
 
-def sanitize_for_bracketed_paste(text: bytes) -> bytes:
-    pat = re.compile(b'(?:(?:\033\\\x5b)|(?:\x9b))201~')
-    while True:
-        new_text = pat.sub(b'', text)
-        if new_text == text:
-            break
-        text = new_text
-    return text
-
-
 def cmdline_for_hold(cmd: Sequence[str] = (), opts: Optional['Options'] = None) -> List[str]:
     if opts is None:
         with suppress(RuntimeError):
@@ -34,6 +34,7 @@
 from .constants import (
     appname,
     config_dir,
+    supports_primary_selection,
     wakeup_io_loop,
 )
 from .fast_data_types import (
@@ -62,6 +63,7 @@
     get_boss,
     get_click_interval,
     get_options,
+    inject_input,
     is_css_pointer_name_valid,
     mark_os_window_dirty,
     mouse_selection,
@@ -93,7 +95,6 @@
     parse_color_set,
     path_from_osc7_url,
     sanitize_control_codes,
-    sanitize_for_bracketed_paste,
 )
 
 MatchPatternType = Union[Pattern[str], Tuple[Pattern[str], Optional[Pattern[str]]]]
@@ -257,7 +258,7 @@ def callback(timer_id: Optional[int]) -> None:
 
 
 def pagerhist(screen: Screen, as_ansi: bool = False, add_wrap_markers: bool = True, upto_output_start: bool = False) -> str:
-    pht = screen.historybuf.pagerhist_as_text(upto_output_start)
+    pht = screen.historybuf.pagerhist_as_text(upto_output_start, add_wrap_markers)
     if pht and (not as_ansi or not add_wrap_markers):
         sanitizer = text_sanitizer(as_ansi, add_wrap_markers)
         pht = sanitizer(pht)
@@ -678,7 +679,6 @@ def send_text(self, *args: str) -> bool:
     def send_key(self, *args: str) -> bool:
         from .options.utils import parse_shortcut
         km = get_options().alatty_mod
-        passthrough = True
         events = []
         prev = ''
         for human_key in args:
@@ -688,23 +688,23 @@ def send_key(self, *args: str) -> bool:
             sk = sk.resolve_alatty_mod(km)
             events.append(KeyEvent(key=sk.key, mods=sk.mods, action=GLFW_REPEAT if human_key == prev else GLFW_PRESS))
             prev = human_key
-        for ev in events + [KeyEvent(key=x.key, mods=x.mods, action=GLFW_RELEASE) for x in reversed(events)]:
-            enc = self.encoded_key(ev)
-            if enc:
-                self.write_to_child(enc)
-                passthrough = False
-        return passthrough
+        events += [KeyEvent(key=x.key, mods=x.mods, action=GLFW_RELEASE) for x in reversed(events)]
+        return not self.inject_input(*events)
 
     def send_key_sequence(self, *keys: KeyEvent, synthesize_release_events: bool = True) -> None:
-        for key in keys:
-            enc = self.encoded_key(key)
-            if enc:
-                self.write_to_child(enc)
-            if synthesize_release_events and key.action != GLFW_RELEASE:
-                rkey = KeyEvent(key=key.key, mods=key.mods, action=GLFW_RELEASE)
-                enc = self.encoded_key(rkey)
-                if enc:
-                    self.write_to_child(enc)
+        self.inject_input(*keys, synthesize_release_events=synthesize_release_events)
+
+    def inject_input(self, *events: Union[KeyEvent, str, bytes], synthesize_release_events: bool = False) -> int:
+        '''
+        Send key events, encoded as per the current keyboard mode of the screen, and
+        text, sent as if pasted, to the child in a single write. Returns the number
+        of bytes written.
+        '''
+        n = inject_input(self.id, events, synthesize_release_events)
+        if n is None:
+            log_error(f'Failed to write to child {self.id} as it does not exist')
+            return 0
+        return n
 
     def write_to_child(self, data: Union[str, bytes]) -> None:
         if data:
@@ -941,14 +941,13 @@ def mouse_selection(self, code: int) -> None:
         mouse_selection(self.os_window_id, self.tab_id, self.id, code, self.current_mouse_event_button)
 
     def paste_selection(self) -> None:
-        txt = get_boss().current_primary_selection()
-        if txt:
-            self.paste_with_actions(txt)
+        boss = get_boss()
+        if supports_primary_selection:
+            boss.paste_clipboard_to_window(boss.primary_selection, self)
 
     def paste_selection_or_clipboard(self) -> None:
-        txt = get_boss().current_primary_selection_or_clipboard()
-        if txt:
-            self.paste_with_actions(txt)
+        boss = get_boss()
+        boss.paste_clipboard_to_window(boss.primary_selection if supports_primary_selection else boss.clipboard, self)
 
     def text_for_selection(self, as_ansi: bool = False) -> str:
         sts = get_options().strip_trailing_spaces
@@ -1087,15 +1086,10 @@ def paste_bytes(self, text: Union[str, bytes]) -> None:
 
     def paste_text(self, text: Union[str, bytes]) -> None:
         if text and not self.destroyed:
-            if isinstance(text, str):
-                text = text.encode('utf-8')
-            if self.screen.in_bracketed_paste_mode:
-                text = sanitize_for_bracketed_paste(text)
-            else:
-                # Workaround for broken editors like nano that cannot handle
-                # newlines in pasted text see https://github.com/kovidgoyal/alatty/issues/994
-                text = text.replace(b'\r\n', b'\n').replace(b'\n', b'\r')
-            self.screen.paste(text)
+            # end of paste markers are removed in bracketed paste mode, otherwise newlines
+            # are sent as carriage returns, for broken editors like nano that cannot handle
+            # newlines in pasted text see https://github.com/kovidgoyal/alatty/issues/994
+            self.inject_input(text)
 
     def clear_screen(self, reset: bool = False, scrollback: bool = False) -> None:
         self.screen.cursor.x = self.screen.cursor.y = 0
@@ -1111,6 +1105,12 @@ def show_cmd_output(self, which: CommandOutput, title: str = 'Command output', a
         text = text.replace('\r\n', '\n').replace('\r', '\n')
         get_boss().display_scrollback(self, text, title=title, report_cursor=False)
 
+    def show_scrollback_memory(self) -> None:
+        usage = self.screen.historybuf.memory_usage()
+        width = max(map(len, usage))
+        text = '\n'.join(f'{k.replace("_", " "):{width}}  {v}' for k, v in usage.items())
+        get_boss().display_scrollback(self, text, title='Scrollback memory', report_cursor=False)
+
     def paste(self, text: str) -> None:
         self.paste_with_actions(text)
 
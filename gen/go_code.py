@@ -79,7 +79,7 @@ def kitten_clis() -> None:
             print(f'package {kitten}')
             print('import "alatty/tools/cli"')
             print('func create_cmd(root *cli.Command, run_func func(*cli.Command, *Options, []string)(int, error)) {')
-            print('ans := root.AddSubCommand(&cli.Command{')
+            print(('ans := ' if has_underscore else '') + 'root.AddSubCommand(&cli.Command{')
             print(f'Name: "{kitten}",')
             if kcd:
                 print(f'ShortDescription: "{serialize_as_go_string(kcd["short_desc"])}",')
@@ -93,12 +93,15 @@ def kitten_clis() -> None:
             print('return run_func(cmd, &opts, args)},')
             if has_underscore:
                 print('Hidden: true,')
-            print('})')
+            # options are only registered when the kitten is actually selected
+            print('Setup: func(ans *cli.Command) {')
             for opt in go_options_for_kitten(kitten):
                 print(opt.as_option('ans'))
                 od.append(opt.struct_declaration())
             if not kcd:
                 print('specialize_command(ans)')
+            print('},')
+            print('})')
             if has_underscore:
                 print("clone := root.AddClone(ans.Group, ans)")
                 print('clone.Hidden = false')
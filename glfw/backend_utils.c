@@ -419,3 +419,112 @@ int createAnonymousFile(off_t size) {
     }
     return fd;
 }
+
+// Reading from pipes without blocking
+
+void
+initPipeReader(PipeReader *pr, int fd, pipe_read_data_func write_data, void *object) {
+    memset(pr, 0, sizeof(pr[0]));
+    pr->fd = fd; pr->write_data = write_data; pr->object = object;
+    pr->status = PIPE_READ_PENDING;
+}
+
+// Read whatever data is currently available from a non-blocking pipe. The
+// amount read per call is capped so that a fast writer cannot starve the event
+// loop. Returns PIPE_READ_PENDING if more data is expected.
+PipeReadStatus
+readPipeData(PipeReader *pr) {
+    char buf[8192];
+    for (unsigned i = 0; i < 64 && pr->status == PIPE_READ_PENDING; i++) {
+        ssize_t n = read(pr->fd, buf, sizeof(buf));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            pr->error = errno;
+            pr->status = PIPE_READ_FAILED;
+        } else if (n == 0) {
+            pr->status = PIPE_READ_DONE;
+        } else {
+            pr->bytes_read += n;
+            if (!pr->write_data(pr->object, buf, n)) pr->status = PIPE_READ_FAILED;
+        }
+    }
+    return pr->status;
+}
+
+typedef struct {
+    PipeReader reader;
+    EventLoopData *eld;
+    const char *name;
+    id_type watch_id, timer_id;
+    monotonic_t timeout, last_activity_at;
+    pipe_read_done_func done;
+} AsyncPipeRead;
+
+static void
+finish_async_pipe_read(AsyncPipeRead *r) {
+    removeWatch(r->eld, r->watch_id);
+    removeTimer(r->eld, r->timer_id);
+    close(r->reader.fd);
+    const bool ok = r->reader.status == PIPE_READ_DONE;
+    if (!ok) {
+        if (r->reader.error == ETIMEDOUT) _glfwInputError(GLFW_PLATFORM_ERROR, "%s: Failed to read data from pipe (timed out)", r->name);
+        else if (r->reader.error) _glfwInputError(GLFW_PLATFORM_ERROR, "%s: Failed to read data from pipe with error: %s", r->name, strerror(r->reader.error));
+        else _glfwInputError(GLFW_PLATFORM_ERROR, "%s: call to write_data() failed with data from pipe", r->name);
+    }
+    r->done(r->reader.object, ok);
+    free(r);
+}
+
+static void
+on_async_pipe_timer(id_type timer_id UNUSED, void *data) {
+    AsyncPipeRead *r = data;
+    if (r->reader.status == PIPE_READ_PENDING) {
+        monotonic_t now = monotonic(), expires_at = r->last_activity_at + r->timeout;
+        if (now < expires_at) {
+            changeTimerInterval(r->eld, r->timer_id, expires_at - now);
+            toggleTimer(r->eld, r->timer_id, 1);
+            return;
+        }
+        r->reader.error = ETIMEDOUT;
+        r->reader.status = PIPE_READ_FAILED;
+    }
+    finish_async_pipe_read(r);
+}
+
+static void
+on_async_pipe_readable(int fd UNUSED, int revents UNUSED, void *data) {
+    AsyncPipeRead *r = data;
+    if (r->reader.status != PIPE_READ_PENDING) return;
+    r->last_activity_at = monotonic();
+    if (readPipeData(&r->reader) != PIPE_READ_PENDING) {
+        // watches must not be removed while they are being dispatched, so
+        // finish from the timer on the next loop iteration instead
+        toggleWatch(r->eld, r->watch_id, 0);
+        changeTimerInterval(r->eld, r->timer_id, 0);
+        toggleTimer(r->eld, r->timer_id, 1);
+    }
+}
+
+// Read all data from fd as it becomes available, from the event loop, taking
+// ownership of fd. done is called exactly once, when the writer closes the
+// pipe, on error, or when no data arrives for timeout, possibly before this
+// function returns.
+bool
+readPipeAsync(EventLoopData *eld, const char *name, int fd, monotonic_t timeout, pipe_read_data_func write_data, pipe_read_done_func done, void *object) {
+    AsyncPipeRead *r = calloc(1, sizeof(AsyncPipeRead));
+    if (!r) { close(fd); done(object, false); return false; }
+    initPipeReader(&r->reader, fd, write_data, object);
+    r->eld = eld; r->name = name; r->timeout = timeout; r->done = done;
+    r->last_activity_at = monotonic();
+    int flags = fcntl(fd, F_GETFL);
+    if (flags == -1 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1) r->reader.error = errno;
+    else if (!(r->watch_id = addWatch(eld, "pipe-read", fd, POLLIN | POLLHUP | POLLERR, 1, on_async_pipe_readable, r))) r->reader.error = EMFILE;
+    else if (!(r->timer_id = addTimer(eld, "pipe-read-timeout", timeout, 1, true, on_async_pipe_timer, r, NULL))) r->reader.error = EMFILE;
+    if (r->reader.error) {
+        r->reader.status = PIPE_READ_FAILED;
+        finish_async_pipe_read(r);
+        return false;
+    }
+    return true;
+}
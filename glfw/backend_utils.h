@@ -79,6 +79,20 @@ typedef struct {
     Timer timers[128];
 } EventLoopData;
 
+typedef bool (*pipe_read_data_func)(void*, const char*, size_t);
+typedef void (*pipe_read_done_func)(void*, bool);
+typedef enum { PIPE_READ_PENDING, PIPE_READ_DONE, PIPE_READ_FAILED } PipeReadStatus;
+
+// The state of an incremental, non-blocking read of all data from a pipe,
+// delivered in chunks to write_data. Independent of any event loop.
+typedef struct {
+    int fd, error;  // error is the errno of a failed read, zero if write_data() failed
+    pipe_read_data_func write_data;
+    void *object;
+    size_t bytes_read;
+    PipeReadStatus status;
+} PipeReader;
+
 
 void check_for_wakeup_events(EventLoopData *eld);
 id_type addWatch(EventLoopData *eld, const char *name, int fd, int events, int enabled, watch_callback_func cb, void *cb_data);
@@ -98,3 +112,6 @@ bool initPollData(EventLoopData *eld, int display_fd);
 void wakeupEventLoop(EventLoopData *eld);
 char* utf_8_strndup(const char* source, size_t max_length);
 int createAnonymousFile(off_t size);
+void initPipeReader(PipeReader *pr, int fd, pipe_read_data_func write_data, void *object);
+PipeReadStatus readPipeData(PipeReader *pr);
+bool readPipeAsync(EventLoopData *eld, const char *name, int fd, monotonic_t timeout, pipe_read_data_func write_data, pipe_read_done_func done, void *object);
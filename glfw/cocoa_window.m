@@ -2802,6 +2802,13 @@ bool _glfwPlatformToggleFullscreen(_GLFWwindow* w, unsigned int flags) {
     }
 }
 
+void
+_glfwPlatformGetClipboardAsync(GLFWClipboardType clipboard_type, const char* mime_type, GLFWclipboardwritedatafun write_data, GLFWclipboarddonefun done, void *object) {
+    // NSPasteboard has no asynchronous read API, so complete the read immediately
+    _glfwPlatformGetClipboard(clipboard_type, mime_type, write_data, object);
+    done(object, true);
+}
+
 static NSMutableData*
 get_clipboard_data(const _GLFWClipboardData *cd, const char *mime) {
     NSMutableData *ans = [NSMutableData dataWithCapacity:8192];
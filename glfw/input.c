@@ -794,6 +794,18 @@ GLFWAPI void glfwGetClipboard(GLFWClipboardType clipboard_type, const char* mime
     _glfwPlatformGetClipboard(clipboard_type, mime_type, write_data, object);
 }
 
+// Like glfwGetClipboard() except that data is read from the event loop rather
+// than by blocking. done is called exactly once, when the read has finished,
+// possibly before this function returns.
+GLFWAPI void glfwGetClipboardAsync(GLFWClipboardType clipboard_type, const char* mime_type, GLFWclipboardwritedatafun write_data, GLFWclipboarddonefun done, void *object) {
+    if (!_glfw.initialized) {
+        _glfwInputError(GLFW_NOT_INITIALIZED, NULL);
+        done(object, false);
+        return;
+    }
+    _glfwPlatformGetClipboardAsync(clipboard_type, mime_type, write_data, done, object);
+}
+
 GLFWAPI void glfwSetClipboardDataTypes(GLFWClipboardType clipboard_type, const char* const *mime_types, size_t num_mime_types, GLFWclipboarditerfun get_data) {
     assert(mime_types != NULL);
     assert(get_data != NULL);
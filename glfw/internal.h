@@ -646,6 +646,7 @@ void _glfwPlatformSetGammaRamp(_GLFWmonitor* monitor, const GLFWgammaramp* ramp)
 
 void _glfwPlatformSetClipboard(GLFWClipboardType t);
 void _glfwPlatformGetClipboard(GLFWClipboardType clipboard_type, const char* mime_type, GLFWclipboardwritedatafun write_data, void *object);
+void _glfwPlatformGetClipboardAsync(GLFWClipboardType clipboard_type, const char* mime_type, GLFWclipboardwritedatafun write_data, GLFWclipboarddonefun done, void *object);
 
 int _glfwPlatformCreateWindow(_GLFWwindow* window,
                               const _GLFWwndconfig* wndconfig,
@@ -1645,8 +1645,12 @@ static void _glfwSendPrimarySelectionText(void *data UNUSED, struct zwp_primary_
 }
 
 static void
-read_offer(int data_pipe, GLFWclipboardwritedatafun write_data, void *object) {
+read_offer(int data_pipe, GLFWclipboardwritedatafun write_data, GLFWclipboarddonefun done, void *object) {
     wl_display_flush(_glfw.wl.display);
+    if (done) {
+        readPipeAsync(&_glfw.wl.eventLoopData, "Wayland: clipboard", data_pipe, s_to_monotonic_t(2ll), write_data, done, object);
+        return;
+    }
     struct pollfd fds;
     fds.fd = data_pipe;
     fds.events = POLLIN;
@@ -1702,7 +1706,7 @@ write_chunk(void *object, const char *data, size_t sz) {
 static char*
 read_offer_string(int data_pipe, size_t *sz) {
     chunked_writer cw = {0};
-    read_offer(data_pipe, write_chunk, &cw);
+    read_offer(data_pipe, write_chunk, NULL, &cw);
     if (cw.buf) {
         *sz = cw.sz;
         return cw.buf;
@@ -1712,21 +1716,27 @@ read_offer_string(int data_pipe, size_t *sz) {
 }
 
 static void
-read_clipboard_data_offer(struct wl_data_offer *data_offer, const char *mime, GLFWclipboardwritedatafun write_data, void *object) {
+read_clipboard_data_offer(struct wl_data_offer *data_offer, const char *mime, GLFWclipboardwritedatafun write_data, GLFWclipboarddonefun done, void *object) {
     int pipefd[2];
-    if (pipe2(pipefd, O_CLOEXEC) != 0) return;
+    if (pipe2(pipefd, O_CLOEXEC) != 0) {
+        if (done) done(object, false);
+        return;
+    }
     wl_data_offer_receive(data_offer, mime, pipefd[1]);
     close(pipefd[1]);
-    read_offer(pipefd[0], write_data, object);
+    read_offer(pipefd[0], write_data, done, object);
 }
 
 static void
-read_primary_selection_offer(struct zwp_primary_selection_offer_v1 *primary_selection_offer, const char *mime, GLFWclipboardwritedatafun write_data, void *object) {
+read_primary_selection_offer(struct zwp_primary_selection_offer_v1 *primary_selection_offer, const char *mime, GLFWclipboardwritedatafun write_data, GLFWclipboarddonefun done, void *object) {
     int pipefd[2];
-    if (pipe2(pipefd, O_CLOEXEC) != 0) return;
+    if (pipe2(pipefd, O_CLOEXEC) != 0) {
+        if (done) done(object, false);
+        return;
+    }
     zwp_primary_selection_offer_v1_receive(primary_selection_offer, mime, pipefd[1]);
     close(pipefd[1]);
-    read_offer(pipefd[0], write_data, object);
+    read_offer(pipefd[0], write_data, done, object);
 }
 
 static char* read_data_offer(struct wl_data_offer *data_offer, const char *mime, size_t *sz) {
@@ -2122,15 +2132,16 @@ plain_text_mime_for_offer(const _GLFWWaylandDataOffer *d) {
     return NULL;
 }
 
-void
-_glfwPlatformGetClipboard(GLFWClipboardType clipboard_type, const char* mime_type, GLFWclipboardwritedatafun write_data, void *object) {
+static void
+get_clipboard(GLFWClipboardType clipboard_type, const char* mime_type, GLFWclipboardwritedatafun write_data, GLFWclipboarddonefun done, void *object) {
+#define finish(ok) { if (done) done(object, ok); return; }
     _GLFWWaylandOfferType offer_type = clipboard_type == GLFW_PRIMARY_SELECTION ? PRIMARY_SELECTION : CLIPBOARD;
     for (size_t i = 0; i < arraysz(_glfw.wl.dataOffers); i++) {
         _GLFWWaylandDataOffer *d = _glfw.wl.dataOffers + i;
         if (d->id && d->offer_type == offer_type) {
             if (d->is_self_offer) {
                 write_data(object, NULL, 1);
-                return;
+                finish(true);
             }
             if (mime_type == NULL) {
                 bool ok = true;
@@ -2144,20 +2155,32 @@ _glfwPlatformGetClipboard(GLFWClipboardType clipboard_type, const char* mime_typ
                     }
                     if (ok) ok = write_data(object, q, strlen(q));
                 }
-                return;
+                finish(ok);
             }
             if (strcmp(mime_type, "text/plain") == 0) {
                 mime_type = plain_text_mime_for_offer(d);
-                if (!mime_type) return;
+                if (!mime_type) finish(true);
             }
             if (d->is_primary) {
-                read_primary_selection_offer(d->id, mime_type, write_data, object);
+                read_primary_selection_offer(d->id, mime_type, write_data, done, object);
             } else {
-                read_clipboard_data_offer(d->id, mime_type, write_data, object);
+                read_clipboard_data_offer(d->id, mime_type, write_data, done, object);
             }
-            break;
+            return;
         }
     }
+    finish(true);
+#undef finish
+}
+
+void
+_glfwPlatformGetClipboard(GLFWClipboardType clipboard_type, const char* mime_type, GLFWclipboardwritedatafun write_data, void *object) {
+    get_clipboard(clipboard_type, mime_type, write_data, NULL, object);
+}
+
+void
+_glfwPlatformGetClipboardAsync(GLFWClipboardType clipboard_type, const char* mime_type, GLFWclipboardwritedatafun write_data, GLFWclipboarddonefun done, void *object) {
+    get_clipboard(clipboard_type, mime_type, write_data, done, object);
 }
 
 EGLenum _glfwPlatformGetEGLPlatform(EGLint** attribs UNUSED)
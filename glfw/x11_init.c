@@ -386,9 +386,12 @@ static bool initExtensions(void)
     _glfw.x11.UTF8_STRING = XInternAtom(_glfw.x11.display, "UTF8_STRING", False);
     _glfw.x11.ATOM_PAIR = XInternAtom(_glfw.x11.display, "ATOM_PAIR", False);
 
-    // Custom selection property atom
-    _glfw.x11.GLFW_SELECTION =
-        XInternAtom(_glfw.x11.display, "GLFW_SELECTION", False);
+    // Custom selection property atoms, successive conversions cycle through them
+    for (size_t i = 0; i < arraysz(_glfw.x11.GLFW_SELECTION); i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "GLFW_SELECTION_%zu", i);
+        _glfw.x11.GLFW_SELECTION[i] = XInternAtom(_glfw.x11.display, name, False);
+    }
 
     // ICCCM standard clipboard atoms
     _glfw.x11.TARGETS = XInternAtom(_glfw.x11.display, "TARGETS", False);
@@ -669,6 +672,7 @@ int _glfwPlatformInit(void)
 void _glfwPlatformTerminate(void)
 {
     removeAllTimers(&_glfw.x11.eventLoopData);
+    _glfwFreeSelectionReadsX11();
     if (_glfw.x11.helperWindowHandle)
     {
         if (XGetSelectionOwner(_glfw.x11.display, _glfw.x11.CLIPBOARD) ==
@@ -212,6 +212,20 @@ typedef struct AtomArray {
     size_t sz, capacity;
 } AtomArray;
 
+// A pending asynchronous read of a selection
+//
+typedef struct _GLFWselectionReadX11
+{
+    Atom selection, property, targets[4];
+    size_t num_targets, current_target;
+    bool started, incr, report_not_found;
+    monotonic_t last_activity_at;
+    GLFWclipboardwritedatafun write_data;
+    GLFWclipboarddonefun done;
+    void *object;
+    struct _GLFWselectionReadX11 *next;
+} _GLFWselectionReadX11;
+
 // X11-specific global data
 //
 typedef struct _GLFWlibraryX11
@@ -290,7 +304,7 @@ typedef struct _GLFWlibraryX11
     Atom            UTF8_STRING;
     Atom            COMPOUND_STRING;
     Atom            ATOM_PAIR;
-    Atom            GLFW_SELECTION;
+    Atom            GLFW_SELECTION[16];
 
     // XRM database atom
     Atom            RESOURCE_MANAGER;
@@ -412,6 +426,13 @@ typedef struct _GLFWlibraryX11
 
     EventLoopData eventLoopData;
 
+    // Selection reads, performed one at a time in the order they were requested
+    struct {
+        struct _GLFWselectionReadX11 *head;
+        id_type timer;
+        unsigned next_property;
+    } selectionReads;
+
 } _GLFWlibraryX11;
 
 // X11-specific per-monitor data
@@ -455,3 +476,4 @@ void _glfwInputErrorX11(int error, const char* message);
 
 void _glfwGetSystemContentScaleX11(float* xscale, float* yscale, bool bypass_cache);
 void _glfwPushSelectionToManagerX11(void);
+void _glfwFreeSelectionReadsX11(void);
@@ -169,15 +169,12 @@ static Bool isFrameExtentsEvent(Display* display UNUSED, XEvent* event, XPointer
            event->xproperty.atom == _glfw.x11.NET_FRAME_EXTENTS;
 }
 
-// Returns whether it is a property event for the specified selection transfer
+// Returns whether it is an event for a selection read by the helper window
 //
-static Bool isSelPropNewValueNotify(Display* display UNUSED, XEvent* event, XPointer pointer)
+static Bool isSelectionReadEvent(Display* display UNUSED, XEvent* event, XPointer pointer UNUSED)
 {
-    XEvent* notification = (XEvent*) pointer;
-    return event->type == PropertyNotify &&
-           event->xproperty.state == PropertyNewValue &&
-           event->xproperty.window == notification->xselection.requestor &&
-           event->xproperty.atom == notification->xselection.property;
+    return (event->type == SelectionNotify && event->xselection.requestor == _glfw.x11.helperWindowHandle) ||
+           (event->type == PropertyNotify && event->xproperty.window == _glfw.x11.helperWindowHandle);
 }
 
 // Translates an X event modifier state mask
@@ -928,130 +925,216 @@ static void handleSelectionRequest(XEvent* event)
     XSendEvent(_glfw.x11.display, request->requestor, False, 0, &reply);
 }
 
+#define SELECTION_READ_TIMEOUT s_to_monotonic_t(2ll)
+#define selection_reads _glfw.x11.selectionReads
+
+static bool
+write_selection_data(Atom target, const char *data, unsigned long item_count, GLFWclipboardwritedatafun write_data, void *object) {
+    if (target == XA_STRING) {
+        char *string = convertLatin1toUTF8(data);
+        bool ok = write_data(object, string, strlen(string));
+        free(string);
+        return ok;
+    }
+    if (target == _glfw.x11.TARGETS) return write_data(object, data, sizeof(Atom) * item_count);
+    return write_data(object, data, item_count);
+}
+
+static void start_selection_read(void);
+
+static void
+finish_selection_read(bool ok) {
+    _GLFWselectionReadX11 *r = selection_reads.head;
+    selection_reads.head = r->next;
+    r->done(r->object, ok);
+    free(r);
+    if (!selection_reads.head && selection_reads.timer) {
+        removeTimer(&_glfw.x11.eventLoopData, selection_reads.timer);
+        selection_reads.timer = 0;
+    }
+    start_selection_read();
+}
+
 static void
-getSelectionString(Atom selection, Atom *targets, size_t num_targets, GLFWclipboardwritedatafun write_data, void *object, bool report_not_found)
-{
-#define XFREE(x) { if (x) XFree(x); x = NULL; }
-    if (XGetSelectionOwner(_glfw.x11.display, selection) == _glfw.x11.helperWindowHandle) {
-        write_data(object, NULL, 1);
+request_selection_target(_GLFWselectionReadX11 *r) {
+    // Every conversion uses the next property, so that a late reply to a
+    // conversion that timed out is not mistaken for the reply to this one
+    r->property = _glfw.x11.GLFW_SELECTION[selection_reads.next_property++ % arraysz(_glfw.x11.GLFW_SELECTION)];
+    r->incr = false;
+    XConvertSelection(_glfw.x11.display, r->selection, r->targets[r->current_target],
+                      r->property, _glfw.x11.helperWindowHandle, CurrentTime);
+    XFlush(_glfw.x11.display);
+    r->last_activity_at = monotonic();
+}
+
+static void
+request_next_selection_target(_GLFWselectionReadX11 *r) {
+    if (++r->current_target < r->num_targets) {
+        request_selection_target(r);
         return;
     }
-    bool found = false;
-    for (size_t i = 0; !found && i < num_targets; i++)
-    {
-        char* data = NULL;
-        Atom actualType = None;
-        int actualFormat = 0;
-        unsigned long itemCount = 0, bytesAfter = 0;
-        monotonic_t start = glfwGetTime();
-        XEvent notification, dummy;
+    if (r->report_not_found) _glfwInputError(GLFW_FORMAT_UNAVAILABLE, "X11: Failed to convert selection to data from clipboard");
+    finish_selection_read(!r->report_not_found);
+}
 
-        XConvertSelection(_glfw.x11.display,
-                          selection,
-                          targets[i],
-                          _glfw.x11.GLFW_SELECTION,
-                          _glfw.x11.helperWindowHandle,
-                          CurrentTime);
+static monotonic_t
+expire_timed_out_selection_read(void) {
+    // Returns the time left before the current read times out
+    _GLFWselectionReadX11 *r = selection_reads.head;
+    if (!r || !r->started) return 0;
+    monotonic_t left = r->last_activity_at + SELECTION_READ_TIMEOUT - monotonic();
+    if (left > 0) return left;
+    _glfwInputError(GLFW_PLATFORM_ERROR, "X11: Failed to read data from clipboard (timed out)");
+    finish_selection_read(false);
+    return 0;
+}
 
-        while (!XCheckTypedWindowEvent(_glfw.x11.display,
-                                       _glfw.x11.helperWindowHandle,
-                                       SelectionNotify,
-                                       &notification))
-        {
-            monotonic_t time = glfwGetTime();
-            if (time - start > s_to_monotonic_t(2ll)) return;
-            waitForX11Event(s_to_monotonic_t(2ll) - (time - start));
-        }
+static void
+on_selection_read_timer(id_type timer_id UNUSED, void *data UNUSED) {
+    monotonic_t left = expire_timed_out_selection_read();
+    if (left > 0 && selection_reads.timer) {
+        changeTimerInterval(&_glfw.x11.eventLoopData, selection_reads.timer, left);
+        toggleTimer(&_glfw.x11.eventLoopData, selection_reads.timer, 1);
+    }
+}
 
-        if (notification.xselection.property == None)
-            continue;
+static void
+start_selection_read(void) {
+    _GLFWselectionReadX11 *r = selection_reads.head;
+    if (!r || r->started) return;
+    r->started = true;
+    if (XGetSelectionOwner(_glfw.x11.display, r->selection) == _glfw.x11.helperWindowHandle) {
+        r->write_data(r->object, NULL, 1);
+        finish_selection_read(true);
+        return;
+    }
+    if (!selection_reads.timer) selection_reads.timer = addTimer(
+            &_glfw.x11.eventLoopData, "selection-read-timeout", SELECTION_READ_TIMEOUT, 1, true, on_selection_read_timer, NULL, NULL);
+    request_selection_target(r);
+}
 
-        XCheckIfEvent(_glfw.x11.display,
-                      &dummy,
-                      isSelPropNewValueNotify,
-                      (XPointer) &notification);
-
-        XGetWindowProperty(_glfw.x11.display,
-                           notification.xselection.requestor,
-                           notification.xselection.property,
-                           0,
-                           LONG_MAX,
-                           True,
-                           AnyPropertyType,
-                           &actualType,
-                           &actualFormat,
-                           &itemCount,
-                           &bytesAfter,
-                           (unsigned char**) &data);
-
-        if (actualType == _glfw.x11.INCR)
-        {
-            for (;;)
-            {
-                start = glfwGetTime();
-                while (!XCheckIfEvent(_glfw.x11.display,
-                                      &dummy,
-                                      isSelPropNewValueNotify,
-                                      (XPointer) &notification))
-                {
-                    monotonic_t time = glfwGetTime();
-                    if (time - start > s_to_monotonic_t(2ll)) {
-                        return;
-                    }
-                    waitForX11Event(s_to_monotonic_t(2ll) - (time - start));
-                }
+static void
+queue_selection_read(Atom selection, const Atom *targets, size_t num_targets, bool report_not_found, GLFWclipboardwritedatafun write_data, GLFWclipboarddonefun done, void *object) {
+    _GLFWselectionReadX11 *r = calloc(1, sizeof(_GLFWselectionReadX11));
+    if (!r) { done(object, false); return; }
+    r->selection = selection;
+    r->num_targets = num_targets < arraysz(r->targets) ? num_targets : arraysz(r->targets);
+    memcpy(r->targets, targets, r->num_targets * sizeof(targets[0]));
+    r->report_not_found = report_not_found;
+    r->write_data = write_data; r->done = done; r->object = object;
+    _GLFWselectionReadX11 **tail = &selection_reads.head;
+    while (*tail) tail = &(*tail)->next;
+    *tail = r;
+    start_selection_read();
+}
 
-                XFREE(data);
-                XGetWindowProperty(_glfw.x11.display,
-                                   notification.xselection.requestor,
-                                   notification.xselection.property,
-                                   0,
-                                   LONG_MAX,
-                                   True,
-                                   AnyPropertyType,
-                                   &actualType,
-                                   &actualFormat,
-                                   &itemCount,
-                                   &bytesAfter,
-                                   (unsigned char**) &data);
-
-                if (itemCount)
-                {
-                    const char *string = data;
-                    if (targets[i] == XA_STRING) {
-                        string = convertLatin1toUTF8(data);
-                        itemCount = strlen(string);
-                    }
-                    bool ok = write_data(object, string, itemCount);
-                    if (string != data) free((void*)string);
-                    if (!ok) { XFREE(data); break; }
-                } else { found = true; break; }
+static bool
+is_reply_to_selection_read(const _GLFWselectionReadX11 *r, const XSelectionEvent *event) {
+    if (!r || !r->started || r->incr || event->selection != r->selection || event->target != r->targets[r->current_target]) return false;
+    // A refusal has no property, so it can only be matched by selection and target
+    return event->property == None || event->property == r->property;
+}
 
-            }
-        }
-        else if (actualType == targets[i])
-        {
-            if (targets[i] == XA_STRING) {
-                const char *string = convertLatin1toUTF8(data);
-                write_data(object, string, strlen(string)); free((void*)string);
-            } else write_data(object, data, itemCount);
-            found = true;
-        }
-        else if (actualType == XA_ATOM && targets[i] == _glfw.x11.TARGETS) {
-            found = true;
-            write_data(object, data, sizeof(Atom) * itemCount);
-        }
+static void
+handleSelectionNotify(const XSelectionEvent *event) {
+    _GLFWselectionReadX11 *r = selection_reads.head;
+    if (!is_reply_to_selection_read(r, event)) {
+        // A late reply to a conversion that was given up on
+        if (event->property != None) XDeleteProperty(_glfw.x11.display, event->requestor, event->property);
+        return;
+    }
+    if (event->property == None) {
+        request_next_selection_target(r);
+        return;
+    }
+    char* data = NULL;
+    Atom actualType = None, target = r->targets[r->current_target];
+    int actualFormat = 0;
+    unsigned long itemCount = 0, bytesAfter = 0;
+    XGetWindowProperty(_glfw.x11.display, event->requestor, event->property, 0, LONG_MAX, True, AnyPropertyType,
+                       &actualType, &actualFormat, &itemCount, &bytesAfter, (unsigned char**) &data);
+    if (actualType == _glfw.x11.INCR) {
+        // the data will arrive in chunks, each signalled by a PropertyNotify
+        r->incr = true;
+        r->last_activity_at = monotonic();
+        if (data) XFree(data);
+    } else if (actualType == target || (actualType == XA_ATOM && target == _glfw.x11.TARGETS)) {
+        bool ok = write_selection_data(target, data, itemCount, r->write_data, r->object);
+        if (data) XFree(data);
+        finish_selection_read(ok);
+    } else {
+        if (data) XFree(data);
+        request_next_selection_target(r);
+    }
+}
+
+static void
+handleSelectionPropertyNotify(const XPropertyEvent *event) {
+    _GLFWselectionReadX11 *r = selection_reads.head;
+    if (!r || !r->incr || event->state != PropertyNewValue || event->atom != r->property) return;
+    char* data = NULL;
+    Atom actualType = None;
+    int actualFormat = 0;
+    unsigned long itemCount = 0, bytesAfter = 0;
+    XGetWindowProperty(_glfw.x11.display, event->window, event->atom, 0, LONG_MAX, True, AnyPropertyType,
+                       &actualType, &actualFormat, &itemCount, &bytesAfter, (unsigned char**) &data);
+    r->last_activity_at = monotonic();
+    if (itemCount) {
+        bool ok = write_selection_data(r->targets[r->current_target], data, itemCount, r->write_data, r->object);
+        if (data) XFree(data);
+        if (!ok) finish_selection_read(false);
+    } else {
+        // a zero length chunk marks the end of the transfer
+        if (data) XFree(data);
+        finish_selection_read(true);
+    }
+}
+
+typedef struct {
+    GLFWclipboardwritedatafun write_data;
+    void *object;
+    bool finished;
+} SyncSelectionRead;
+
+static bool
+write_sync_selection_data(void *object, const char *data, size_t sz) {
+    SyncSelectionRead *s = object;
+    return s->write_data(s->object, data, sz);
+}
 
-        XFREE(data);
+static void
+on_sync_selection_read_done(void *object, bool ok UNUSED) {
+    ((SyncSelectionRead*)object)->finished = true;
+}
 
+static void
+getSelectionString(Atom selection, Atom *targets, size_t num_targets, GLFWclipboardwritedatafun write_data, void *object, bool report_not_found)
+{
+    // The read is queued behind any asynchronous ones, so that only one
+    // conversion is ever in flight, and their events are processed here
+    // until it is done
+    SyncSelectionRead s = {.write_data=write_data, .object=object};
+    queue_selection_read(selection, targets, num_targets, report_not_found, write_sync_selection_data, on_sync_selection_read_done, &s);
+    while (!s.finished) {
+        XEvent event;
+        if (XCheckIfEvent(_glfw.x11.display, &event, isSelectionReadEvent, NULL)) {
+            if (event.type == SelectionNotify) handleSelectionNotify(&event.xselection);
+            else handleSelectionPropertyNotify(&event.xproperty);
+            continue;
+        }
+        monotonic_t left = expire_timed_out_selection_read();
+        if (left > 0) waitForX11Event(left);
     }
+}
 
-    if (!found && report_not_found)
-    {
-        _glfwInputError(GLFW_FORMAT_UNAVAILABLE,
-                        "X11: Failed to convert selection to data from clipboard");
+void
+_glfwFreeSelectionReadsX11(void) {
+    while (selection_reads.head) {
+        _GLFWselectionReadX11 *r = selection_reads.head;
+        selection_reads.head = r->next;
+        free(r);
     }
-#undef XFREE
+    selection_reads.timer = 0;
 }
 
 // Make the specified window and its video mode active on its monitor
@@ -1194,6 +1277,16 @@ static void processEvent(XEvent *event)
         handleSelectionRequest(event);
         return;
     }
+    else if (event->type == SelectionNotify && event->xselection.requestor == _glfw.x11.helperWindowHandle)
+    {
+        handleSelectionNotify(&event->xselection);
+        return;
+    }
+    else if (event->type == PropertyNotify && event->xproperty.window == _glfw.x11.helperWindowHandle)
+    {
+        handleSelectionPropertyNotify(&event->xproperty);
+        return;
+    }
     else if (event->type == _glfw.x11.xkb.eventBase)
     {
         XkbEvent *kb_event = (XkbEvent*)event;
@@ -2957,19 +3050,12 @@ write_chunk(void *object, const char *data, size_t sz) {
     return true;
 }
 
-static void
-get_available_mime_types(Atom which_clipboard, GLFWclipboardwritedatafun write_data, void *object) {
-    chunked_writer cw = {0};
-    getSelectionString(which_clipboard, &_glfw.x11.TARGETS, 1, write_chunk, &cw, false);
-    if (cw.is_self_offer) {
-        write_data(object, NULL, 1);
-        return;
-    }
-    size_t count = 0;
+static bool
+write_mime_types_for_targets(const chunked_writer *cw, GLFWclipboardwritedatafun write_data, void *object) {
     bool ok = true;
-    if (cw.buf) {
-        Atom *atoms = (Atom*)cw.buf;
-        count = cw.sz / sizeof(Atom);
+    if (cw->buf) {
+        Atom *atoms = (Atom*)cw->buf;
+        size_t count = cw->sz / sizeof(Atom);
         char **names = calloc(count, sizeof(char*));
         get_atom_names(atoms, count, names);
         for (size_t i = 0; i < count; i++) {
@@ -2982,18 +3068,42 @@ get_available_mime_types(Atom which_clipboard, GLFWclipboardwritedatafun write_d
             }
             XFree(names[i]);
         }
-        free(cw.buf);
         free(names);
     }
+    return ok;
 }
 
-void
-_glfwPlatformGetClipboard(GLFWClipboardType clipboard_type, const char* mime_type, GLFWclipboardwritedatafun write_data, void *object) {
-    Atom atoms[4], which = clipboard_type == GLFW_PRIMARY_SELECTION ? _glfw.x11.PRIMARY : _glfw.x11.CLIPBOARD;
-    if (mime_type == NULL) {
-        get_available_mime_types(which, write_data, object);
+static void
+get_available_mime_types(Atom which_clipboard, GLFWclipboardwritedatafun write_data, void *object) {
+    chunked_writer cw = {0};
+    getSelectionString(which_clipboard, &_glfw.x11.TARGETS, 1, write_chunk, &cw, false);
+    if (cw.is_self_offer) {
+        write_data(object, NULL, 1);
         return;
     }
+    write_mime_types_for_targets(&cw, write_data, object);
+    free(cw.buf);
+}
+
+typedef struct {
+    chunked_writer cw;
+    GLFWclipboardwritedatafun write_data;
+    GLFWclipboarddonefun done;
+    void *object;
+} MimeTypesRead;
+
+static void
+on_targets_read(void *object, bool ok) {
+    MimeTypesRead *m = object;
+    if (m->cw.is_self_offer) m->write_data(m->object, NULL, 1);
+    else if (ok) ok = write_mime_types_for_targets(&m->cw, m->write_data, m->object);
+    free(m->cw.buf);
+    m->done(m->object, ok);
+    free(m);
+}
+
+static size_t
+targets_for_mime(const char *mime_type, Atom *atoms) {
     size_t count = 0;
     if (strcmp(mime_type, "text/plain") == 0) {
         // UTF8_STRING is what xclip uses by default, and there are people out there that expect to be able to paste from it with a single read operation. See https://github.com/kovidgoyal/alatty/issues/5842
@@ -3007,9 +3117,34 @@ _glfwPlatformGetClipboard(GLFWClipboardType clipboard_type, const char* mime_typ
     } else {
         atoms[count++] = atom_for_mime(mime_type).atom;
     }
+    return count;
+}
+
+void
+_glfwPlatformGetClipboard(GLFWClipboardType clipboard_type, const char* mime_type, GLFWclipboardwritedatafun write_data, void *object) {
+    Atom atoms[4], which = clipboard_type == GLFW_PRIMARY_SELECTION ? _glfw.x11.PRIMARY : _glfw.x11.CLIPBOARD;
+    if (mime_type == NULL) {
+        get_available_mime_types(which, write_data, object);
+        return;
+    }
+    size_t count = targets_for_mime(mime_type, atoms);
     getSelectionString(which, atoms, count, write_data, object, true);
 }
 
+void
+_glfwPlatformGetClipboardAsync(GLFWClipboardType clipboard_type, const char* mime_type, GLFWclipboardwritedatafun write_data, GLFWclipboarddonefun done, void *object) {
+    Atom atoms[4], which = clipboard_type == GLFW_PRIMARY_SELECTION ? _glfw.x11.PRIMARY : _glfw.x11.CLIPBOARD;
+    if (mime_type == NULL) {
+        MimeTypesRead *m = calloc(1, sizeof(MimeTypesRead));
+        if (!m) { done(object, false); return; }
+        m->write_data = write_data; m->done = done; m->object = object;
+        queue_selection_read(which, &_glfw.x11.TARGETS, 1, false, write_chunk, on_targets_read, m);
+        return;
+    }
+    size_t count = targets_for_mime(mime_type, atoms);
+    queue_selection_read(which, atoms, count, true, write_data, done, object);
+}
+
 EGLenum _glfwPlatformGetEGLPlatform(EGLint** attribs)
 {
     if (_glfw.egl.ANGLE_platform_angle)
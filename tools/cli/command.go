@@ -33,6 +33,9 @@ type Command struct {
 	IgnoreAllArgs bool
 	// Callback that is called on error
 	CallbackOnError func(cmd *Command, err error, during_parsing bool, exit_code int) (final_exit_code int)
+	// Called to add options and sub-commands the first time this command is actually used,
+	// so that commands that are not selected on the command line cost nothing at startup
+	Setup func(cmd *Command)
 
 	SubCommandGroups []*CommandGroup
 	OptionGroups     []*OptionGroup
@@ -78,7 +81,34 @@ func (self *Command) AddSubCommand(ans *Command) *Command {
 	return ans
 }
 
+func (self *Command) ensure_setup() {
+	if self.Setup != nil {
+		setup := self.Setup
+		self.Setup = nil
+		setup(self)
+	}
+}
+
+// Validate this command and all its sub-commands, running any pending Setup functions
 func (self *Command) Validate() error {
+	err := self.validate()
+	if err != nil {
+		return err
+	}
+	for _, g := range self.SubCommandGroups {
+		for _, sc := range g.SubCommands {
+			if err = sc.Validate(); err != nil {
+				return err
+			}
+		}
+	}
+	return nil
+}
+
+// Validate only this command, building its option map. Sub-commands are
+// validated as they are selected during parsing.
+func (self *Command) validate() error {
+	self.ensure_setup()
 	seen_sc := make(map[string]bool)
 	for _, g := range self.SubCommandGroups {
 		for _, sc := range g.SubCommands {
@@ -86,10 +116,6 @@ func (self *Command) Validate() error {
 				return &ParseError{Message: fmt.Sprintf("The sub-command :yellow:`%s` occurs twice inside %s", sc.Name, self.Name)}
 			}
 			seen_sc[sc.Name] = true
-			err := sc.Validate()
-			if err != nil {
-				return err
-			}
 		}
 	}
 	seen_flags := make(map[string]bool)
@@ -154,7 +180,7 @@ func (self *Command) CommandStringForUsage() string {
 func (self *Command) ParseArgs(args []string) (*Command, error) {
 	for ; self.Parent != nil; self = self.Parent {
 	}
-	err := self.Validate()
+	err := self.validate()
 	if err != nil {
 		return nil, err
 	}
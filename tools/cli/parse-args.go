@@ -103,6 +103,9 @@ func (self *Command) parse_args(ctx *Context, args []string) error {
 				if self.HasSubCommands() {
 					possible_cmds := self.FindSubCommands(arg)
 					if len(possible_cmds) == 1 {
+						if err := possible_cmds[0].validate(); err != nil {
+							return err
+						}
 						return possible_cmds[0].parse_args(ctx, args_to_parse)
 					}
 					if !self.SubCommandIsOptional {
@@ -70,18 +70,19 @@ func EntryPoint(root *cli.Command) *cli.Command {
 			}
 			return main(args, opts)
 		},
+		Setup: func(sc *cli.Command) {
+			sc.Add(cli.OptionSpec{
+				Name:    "--shell",
+				Default: ".",
+			})
+			sc.Add(cli.OptionSpec{
+				Name: "--env",
+				Type: "list",
+			})
+			sc.Add(cli.OptionSpec{
+				Name: "--cwd",
+			})
+		},
 	})
-	sc.Add(cli.OptionSpec{
-		Name:    "--shell",
-		Default: ".",
-	})
-	sc.Add(cli.OptionSpec{
-		Name: "--env",
-		Type: "list",
-	})
-	sc.Add(cli.OptionSpec{
-		Name: "--cwd",
-	})
-
 	return sc
 }
@@ -105,11 +105,13 @@ func EntryPoint(root *cli.Command) *cli.Command {
 			}
 			return main(args, opts)
 		},
-	})
-	sc.Add(cli.OptionSpec{
-		Name:    "--title",
-		Default: "ERROR",
-		Help:    "The title for the error message",
+		Setup: func(sc *cli.Command) {
+			sc.Add(cli.OptionSpec{
+				Name:    "--title",
+				Default: "ERROR",
+				Help:    "The title for the error message",
+			})
+		},
 	})
 	return sc
 }
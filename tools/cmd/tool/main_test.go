@@ -0,0 +1,80 @@
+// License: GPLv3 Copyright: 2026, alatty contributors
+
+package tool
+
+import (
+	"testing"
+
+	"alatty/kittens/ask"
+	"alatty/tools/cli"
+)
+
+// Build the command tree the same way the kitten binary does
+func build_root_command() *cli.Command {
+	root := cli.NewRootCommand()
+	root.Run = func(cmd *cli.Command, args []string) (int, error) {
+		return 0, nil
+	}
+	AlattyToolEntryPoints(root)
+	return root
+}
+
+var kitten_command_line = []string{"kitten", "ask", "--type", "yesno", "--default", "n", "--message", "Are you sure?"}
+
+func TestParseKittenCommandLine(t *testing.T) {
+	root := build_root_command()
+	cmd, err := root.ParseArgs(kitten_command_line)
+	if err != nil {
+		t.Fatal(err)
+	}
+	if cmd.Name != "ask" {
+		t.Fatalf("Parsing selected the command: %s", cmd.Name)
+	}
+	opts := ask.Options{}
+	if err = cmd.GetOptionValues(&opts); err != nil {
+		t.Fatal(err)
+	}
+	if opts.Type != "yesno" || opts.Default != "n" || opts.Message != "Are you sure?" {
+		t.Fatalf("Incorrect option values: %#v", opts)
+	}
+	if root.FindSubCommand("run-shell").Setup == nil {
+		t.Fatal("A command that was not on the command line was set up")
+	}
+	if err = root.Validate(); err != nil {
+		t.Fatal(err)
+	}
+	if root.FindSubCommand("run-shell").FindOption("--shell") == nil {
+		t.Fatal("Validate() did not set up all commands")
+	}
+}
+
+func BenchmarkBuildRootCommand(b *testing.B) {
+	b.ReportAllocs()
+	for i := 0; i < b.N; i++ {
+		build_root_command()
+	}
+}
+
+func BenchmarkParseKittenCommandLine(b *testing.B) {
+	b.Run("lazy", func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			if _, err := build_root_command().ParseArgs(kitten_command_line); err != nil {
+				b.Fatal(err)
+			}
+		}
+	})
+	// What startup costs when every command is set up, as it was before Setup existed
+	b.Run("eager", func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			root := build_root_command()
+			if err := root.Validate(); err != nil {
+				b.Fatal(err)
+			}
+			if _, err := root.ParseArgs(kitten_command_line); err != nil {
+				b.Fatal(err)
+			}
+		}
+	})
+}
@@ -89,7 +89,8 @@ type Loop struct {
 	// Called when a response to an rc command is received
 	OnRCResponse func(data []byte) error
 
-	// Called when any input from tty is received
+	// Called when any input from tty is received. data is only valid until
+	// this function returns, make a copy to keep it.
 	OnReceivedData func(data []byte) error
 
 	// Called when an escape code is received that is not handled by any other handler
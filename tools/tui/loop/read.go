@@ -40,7 +40,33 @@ func read_ignoring_temporary_errors(f *tty.Term, buf []byte) (int, error) {
 	return n, err
 }
 
-func read_from_tty(pipe_r *os.File, term *tty.Term, results_channel chan<- []byte, err_channel chan<- error, quit_channel <-chan byte) {
+const (
+	tty_read_buffer_size = 2 * utils.DEFAULT_IO_BUFFER_SIZE
+	// The number of buffers shared by the tty reader and the main loop. Once
+	// they are all waiting to be dispatched the reader stops reading, applying
+	// backpressure to the terminal rather than queueing data without bound.
+	num_tty_read_buffers = 4
+)
+
+// A fixed set of buffers, recycled between the tty reader and the main loop
+// so that reading large amounts of input does not churn the GC. Buffers are
+// sent to the main loop as filled slices and must be returned with put() once
+// they have been dispatched.
+type tty_read_buffer_pool chan []byte
+
+func new_tty_read_buffer_pool() tty_read_buffer_pool {
+	ans := make(tty_read_buffer_pool, num_tty_read_buffers)
+	for i := 0; i < num_tty_read_buffers; i++ {
+		ans <- make([]byte, tty_read_buffer_size)
+	}
+	return ans
+}
+
+func (self tty_read_buffer_pool) put(buf []byte) {
+	self <- buf[:cap(buf)]
+}
+
+func read_from_tty(pipe_r *os.File, term *tty.Term, results_channel chan<- []byte, free_buffers tty_read_buffer_pool, err_channel chan<- error, quit_channel <-chan byte) {
 	keep_going := true
 	pipe_fd := int(pipe_r.Fd())
 	tty_fd := term.Fd()
@@ -53,8 +79,6 @@ func read_from_tty(pipe_r *os.File, term *tty.Term, results_channel chan<- []byt
 		pipe_r.Close()
 	}()
 
-	const bufsize = 2 * utils.DEFAULT_IO_BUFFER_SIZE
-
 	wait_for_read_available := func() {
 		for {
 			n, err := selector.WaitForever()
@@ -72,28 +96,61 @@ func read_from_tty(pipe_r *os.File, term *tty.Term, results_channel chan<- []byt
 		}
 	}
 
-	buf := make([]byte, bufsize)
-	for keep_going {
-		if len(buf) < 64 {
-			buf = make([]byte, bufsize)
+	is_read_available := func() bool {
+		n, err := selector.Wait(0)
+		if err != nil || n < 1 {
+			return false
 		}
-		if wait_for_read_available(); !keep_going {
-			break
-		}
-		n, err := read_ignoring_temporary_errors(term, buf)
-		if err != nil {
-			err_channel <- err
+		if selector.IsReadyToRead(pipe_fd) {
 			keep_going = false
-			break
-		}
-		if n == 0 { // temporary error
-			continue
+			return false
 		}
-		send := buf[:n]
-		buf = buf[n:]
+		return selector.IsReadyToRead(tty_fd)
+	}
+
+	for keep_going {
+		var buf []byte
 		select {
-		case results_channel <- send:
+		case buf = <-free_buffers:
 		case <-quit_channel:
+			return
+		}
+		// Coalesce data that is already available into a single buffer so
+		// that large pastes and streamed replies are dispatched in few chunks
+		n := 0
+		var read_err error
+		for keep_going && len(buf)-n >= 64 {
+			if n == 0 {
+				wait_for_read_available()
+			} else if !is_read_available() {
+				break
+			}
+			if !keep_going {
+				break
+			}
+			m, err := read_ignoring_temporary_errors(term, buf[n:])
+			if err != nil {
+				read_err = err
+				break
+			}
+			if m == 0 && n > 0 { // temporary error
+				break
+			}
+			n += m
+		}
+		if n > 0 && keep_going {
+			select {
+			case results_channel <- buf[:n]:
+				buf = nil
+			case <-quit_channel:
+				keep_going = false
+			}
+		}
+		if buf != nil {
+			free_buffers.put(buf)
+		}
+		if read_err != nil {
+			err_channel <- read_err
 			keep_going = false
 		}
 	}
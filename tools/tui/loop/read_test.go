@@ -0,0 +1,215 @@
+// License: GPLv3 Copyright: 2026, alatty contributors
+
+package loop
+
+import (
+	"bytes"
+	"os"
+	"testing"
+	"time"
+
+	"golang.org/x/sys/unix"
+
+	"alatty/tools/tty"
+)
+
+// A tty reader fed from a pipe, started and shut down the same way as in run()
+type test_tty_reader struct {
+	term           *tty.Term
+	tty_w          *os.File
+	buffers        tty_read_buffer_pool
+	results        chan []byte
+	errors         chan error
+	quit_r, quit_w *os.File
+	quit_channel   chan byte
+	received       bytes.Buffer
+	held_buffer    []byte
+}
+
+func new_test_tty_reader(t testing.TB) *test_tty_reader {
+	tty_r, tty_w, err := os.Pipe()
+	if err != nil {
+		t.Fatal(err)
+	}
+	// the Term needs its own descriptor as the one in tty_r is closed when tty_r is garbage collected
+	fd, err := unix.Dup(int(tty_r.Fd()))
+	tty_r.Close()
+	if err != nil {
+		t.Fatal(err)
+	}
+	term, err := tty.WrapTerm(fd, "test-tty")
+	if err != nil {
+		t.Fatal(err)
+	}
+	ans := &test_tty_reader{term: term, tty_w: tty_w, buffers: new_tty_read_buffer_pool(), errors: make(chan error, 8)}
+	return ans
+}
+
+func (self *test_tty_reader) start(t testing.TB) {
+	var err error
+	if self.quit_r, self.quit_w, err = os.Pipe(); err != nil {
+		t.Fatal(err)
+	}
+	self.results = make(chan []byte, num_tty_read_buffers)
+	self.quit_channel = make(chan byte)
+	go read_from_tty(self.quit_r, self.term, self.results, self.buffers, self.errors, self.quit_channel)
+}
+
+func (self *test_tty_reader) shutdown(t testing.TB) {
+	self.quit_w.Close()
+	close(self.quit_channel)
+	done := make(chan bool)
+	go func() {
+		for buf := range self.results {
+			self.buffers.put(buf)
+		}
+		done <- true
+	}()
+	select {
+	case <-done:
+	case <-time.After(5 * time.Second):
+		t.Fatal("The tty reader did not exit after being shut down")
+	}
+	select {
+	case err := <-self.errors:
+		t.Fatalf("The tty reader failed with error: %s", err)
+	default:
+	}
+}
+
+// Receive until n bytes have arrived in total, returning all buffers except
+// the last one to the pool, the last one is kept if hold is true.
+func (self *test_tty_reader) receive(t testing.TB, n int, hold bool) {
+	for self.received.Len() < n {
+		select {
+		case buf := <-self.results:
+			self.received.Write(buf)
+			if hold && self.received.Len() >= n {
+				self.held_buffer = buf
+			} else {
+				self.buffers.put(buf)
+			}
+		case err := <-self.errors:
+			t.Fatalf("The tty reader failed with error: %s", err)
+		case <-time.After(5 * time.Second):
+			t.Fatalf("Timed out waiting for data, received %d of %d bytes", self.received.Len(), n)
+		}
+	}
+}
+
+func (self *test_tty_reader) close() {
+	self.tty_w.Close()
+	self.term.Close()
+}
+
+func test_data(size int) []byte {
+	ans := make([]byte, size)
+	for i := range ans {
+		ans[i] = byte('a' + i%26)
+	}
+	return ans
+}
+
+func write_in_background(w *os.File, data []byte) <-chan error {
+	ans := make(chan error, 1)
+	go func() {
+		_, err := w.Write(data)
+		ans <- err
+	}()
+	return ans
+}
+
+func TestReadFromTTY(t *testing.T) {
+	r := new_test_tty_reader(t)
+	defer r.close()
+	r.start(t)
+	// more than all buffers together, so that the reader has to wait for buffers to be returned
+	data := test_data(3 * num_tty_read_buffers * tty_read_buffer_size)
+	written := write_in_background(r.tty_w, data)
+	r.receive(t, len(data), false)
+	if err := <-written; err != nil {
+		t.Fatal(err)
+	}
+	if !bytes.Equal(r.received.Bytes(), data) {
+		t.Fatal("The data read from the tty is not the data that was written")
+	}
+	r.shutdown(t)
+	if len(r.buffers) != num_tty_read_buffers {
+		t.Fatalf("%d of %d buffers were returned to the pool", len(r.buffers), num_tty_read_buffers)
+	}
+}
+
+func TestReadFromTTYRestart(t *testing.T) {
+	// Mimics SuspendAndRun, which shuts the reader down and starts a new one
+	// while the main loop is still dispatching a buffer from the old one
+	r := new_test_tty_reader(t)
+	defer r.close()
+	r.start(t)
+	first := test_data(1000)
+	write_in_background(r.tty_w, first)
+	r.receive(t, len(first), true)
+	r.shutdown(t)
+	if r.held_buffer == nil {
+		t.Fatal("No buffer was held")
+	}
+
+	r.start(t)
+	second := bytes.ToUpper(test_data(2 * tty_read_buffer_size))
+	write_in_background(r.tty_w, second)
+	r.buffers.put(r.held_buffer)
+	r.held_buffer = nil
+	r.receive(t, len(first)+len(second), false)
+	if !bytes.Equal(r.received.Bytes(), append(first, second...)) {
+		t.Fatal("The data read from the tty across a restart is not the data that was written")
+	}
+	r.shutdown(t)
+	if len(r.buffers) != num_tty_read_buffers {
+		t.Fatalf("%d of %d buffers were returned to the pool", len(r.buffers), num_tty_read_buffers)
+	}
+}
+
+func TestReadFromTTYShutdownWhileBlocked(t *testing.T) {
+	// With every buffer waiting to be dispatched the reader blocks, shutting
+	// down must still make it exit
+	r := new_test_tty_reader(t)
+	defer r.close()
+	r.start(t)
+	write_in_background(r.tty_w, test_data((num_tty_read_buffers+1)*tty_read_buffer_size))
+	deadline := time.Now().Add(5 * time.Second)
+	for len(r.results) < num_tty_read_buffers {
+		if time.Now().After(deadline) {
+			t.Fatalf("Only %d buffers were filled", len(r.results))
+		}
+		time.Sleep(time.Millisecond)
+	}
+	r.shutdown(t)
+	if len(r.buffers) != num_tty_read_buffers {
+		t.Fatalf("%d of %d buffers were returned to the pool", len(r.buffers), num_tty_read_buffers)
+	}
+}
+
+func BenchmarkReadFromTTY(b *testing.B) {
+	r := new_test_tty_reader(b)
+	defer r.close()
+	r.start(b)
+	chunk := test_data(4096)
+	b.SetBytes(int64(len(chunk)))
+	b.ReportAllocs()
+	b.ResetTimer()
+	go func() {
+		for i := 0; i < b.N; i++ {
+			if _, err := r.tty_w.Write(chunk); err != nil {
+				b.Error(err)
+				return
+			}
+		}
+	}()
+	total := b.N * len(chunk)
+	for n := 0; n < total; {
+		buf := <-r.results
+		n += len(buf)
+		r.buffers.put(buf)
+	}
+	b.StopTimer()
+	r.shutdown(b)
+}
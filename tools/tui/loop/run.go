@@ -303,15 +303,18 @@ func (self *Loop) run() (err error) {
 	var r_r, r_w, w_r, w_w *os.File
 	var tty_reading_done_channel chan byte
 	var tty_read_channel chan []byte
+	// Shared by all tty readers started during this run, since SuspendAndRun
+	// can restart the reader while one of its buffers is still being dispatched
+	tty_read_buffers := new_tty_read_buffer_pool()
 
 	start_tty_reader := func() (err error) {
 		r_r, r_w, err = os.Pipe()
 		if err != nil {
 			return err
 		}
-		tty_read_channel = make(chan []byte)
+		tty_read_channel = make(chan []byte, num_tty_read_buffers)
 		tty_reading_done_channel = make(chan byte)
-		go read_from_tty(r_r, controlling_term, tty_read_channel, err_channel, tty_reading_done_channel)
+		go read_from_tty(r_r, controlling_term, tty_read_channel, tty_read_buffers, err_channel, tty_reading_done_channel)
 		return
 	}
 	err = start_tty_reader()
@@ -337,7 +340,8 @@ func (self *Loop) run() (err error) {
 	}
 	wait_for_tty_reader_to_quit := func() {
 		// wait for tty reader to exit cleanly
-		for range tty_read_channel {
+		for buf := range tty_read_channel {
+			tty_read_buffers.put(buf)
 		}
 	}
 
@@ -482,6 +486,7 @@ func (self *Loop) run() (err error) {
 				}
 			}
 			err := self.dispatch_input_data(input_data)
+			tty_read_buffers.put(input_data)
 			if err != nil {
 				return err
 			}
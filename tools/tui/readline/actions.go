@@ -10,6 +10,8 @@ import (
 
 	"alatty/tools/utils"
 	"alatty/tools/wcswidth"
+
+	"golang.org/x/exp/slices"
 )
 
 var _ = fmt.Print
@@ -62,47 +64,28 @@ func (self *Readline) set_text(text string) {
 }
 
 func (self *Readline) add_text(text string) {
-	new_lines := make([]string, 0, len(self.input_state.lines)+4)
-	new_lines = append(new_lines, self.input_state.lines[:self.input_state.cursor.Y]...)
-	var lines_after []string
-	if len(self.input_state.lines) > self.input_state.cursor.Y+1 {
-		lines_after = self.input_state.lines[self.input_state.cursor.Y+1:]
-	}
-	has_trailing_newline := strings.HasSuffix(text, "\n")
-
-	add_line_break := func(line string) {
-		new_lines = append(new_lines, line)
-		self.input_state.cursor.X = len(line)
-		self.input_state.cursor.Y += 1
-	}
-	cline := self.input_state.lines[self.input_state.cursor.Y]
-	before_first_line := cline[:self.input_state.cursor.X]
-	after_first_line := ""
-	if self.input_state.cursor.X < len(cline) {
-		after_first_line = cline[self.input_state.cursor.X:]
-	}
-	for i, line := range utils.Splitlines(text) {
-		if i > 0 {
-			add_line_break(line)
-		} else {
-			line := before_first_line + line
-			self.input_state.cursor.X = len(line)
-			new_lines = append(new_lines, line)
-		}
-	}
-	if has_trailing_newline {
-		add_line_break("")
+	new_lines := utils.Splitlines(text)
+	if strings.HasSuffix(text, "\n") {
+		new_lines = append(new_lines, "")
 	}
-	if after_first_line != "" {
-		if len(new_lines) == 0 {
-			new_lines = append(new_lines, "")
-		}
-		new_lines[len(new_lines)-1] += after_first_line
+	if len(new_lines) == 0 {
+		return
 	}
-	if len(lines_after) > 0 {
-		new_lines = append(new_lines, lines_after...)
+	self.text_changed()
+	cursor := &self.input_state.cursor
+	cline := self.input_state.lines[cursor.Y]
+	last := len(new_lines) - 1
+	new_lines[0] = cline[:cursor.X] + new_lines[0]
+	after_last_line := cline[cursor.X:]
+	cursor.X = len(new_lines[last])
+	new_lines[last] += after_last_line
+	if last == 0 {
+		// The common case of typing into a single line, edit it in place
+		self.input_state.lines[cursor.Y] = new_lines[0]
+		return
 	}
-	self.input_state.lines = new_lines
+	self.input_state.lines = slices.Replace(self.input_state.lines, cursor.Y, cursor.Y+1, new_lines...)
+	cursor.Y += last
 }
 
 func (self *Readline) move_cursor_left(amt uint, traverse_line_breaks bool) (amt_moved uint) {
@@ -213,6 +196,7 @@ func (self *Readline) erase_between(start, end Position) string {
 	if end.Less(start) {
 		start, end = end, start
 	}
+	self.text_changed()
 	buf := strings.Builder{}
 	if start.Y == end.Y {
 		line := self.input_state.lines[start.Y]
@@ -227,36 +211,31 @@ func (self *Readline) erase_between(start, end Position) string {
 		}
 		return buf.String()
 	}
-	lines := make([]string, 0, len(self.input_state.lines))
-	for i, line := range self.input_state.lines {
-		if i < start.Y || i > end.Y {
-			lines = append(lines, line)
-		} else if i == start.Y {
-			lines = append(lines, line[:start.X])
-			buf.WriteString(line[start.X:])
-			if self.input_state.cursor.Y == i && self.input_state.cursor.X > start.X {
-				self.input_state.cursor.X = start.X
-			}
-		} else if i == end.Y {
-			lines[len(lines)-1] += line[end.X:]
-			buf.WriteString(line[:end.X])
-			if i == self.input_state.cursor.Y {
-				self.input_state.cursor.Y = start.Y
-				if self.input_state.cursor.X < end.X {
-					self.input_state.cursor.X = start.X
-				} else {
-					self.input_state.cursor.X -= end.X - start.X
-				}
-			}
+	lines := self.input_state.lines
+	buf.WriteString(lines[start.Y][start.X:])
+	for _, line := range lines[start.Y+1 : end.Y] {
+		buf.WriteString(line)
+		buf.WriteString("\n")
+	}
+	buf.WriteString(lines[end.Y][:end.X])
+	cursor := &self.input_state.cursor
+	switch {
+	case cursor.Y == start.Y:
+		if cursor.X > start.X {
+			cursor.X = start.X
+		}
+	case start.Y < cursor.Y && cursor.Y < end.Y:
+		*cursor = start
+	case cursor.Y == end.Y:
+		cursor.Y = start.Y
+		if cursor.X < end.X {
+			cursor.X = start.X
 		} else {
-			if i == self.input_state.cursor.Y {
-				self.input_state.cursor = start
-			}
-			buf.WriteString(line)
-			buf.WriteString("\n")
+			cursor.X -= end.X - start.X
 		}
 	}
-	self.input_state.lines = lines
+	lines[start.Y] = lines[start.Y][:start.X] + lines[end.Y][end.X:]
+	self.input_state.lines = slices.Delete(lines, start.Y+1, end.Y+1)
 	return buf.String()
 }
 
@@ -380,6 +359,7 @@ func (self *Readline) kill_to_end_of_line() bool {
 	if self.input_state.cursor.X >= len(line) {
 		return false
 	}
+	self.text_changed()
 	self.input_state.lines[self.input_state.cursor.Y] = line[:self.input_state.cursor.X]
 	self.kill_text(line[self.input_state.cursor.X:])
 	return true
@@ -390,6 +370,7 @@ func (self *Readline) kill_to_start_of_line() bool {
 	if self.input_state.cursor.X <= 0 {
 		return false
 	}
+	self.text_changed()
 	self.input_state.lines[self.input_state.cursor.Y] = line[self.input_state.cursor.X:]
 	self.kill_text(line[:self.input_state.cursor.X])
 	self.input_state.cursor.X = 0
@@ -507,6 +488,7 @@ func (self *Readline) _perform_action(ac Action, repeat_count uint) (err error,
 	case ActionClearScreen:
 		self.loop.StartAtomicUpdate()
 		self.loop.ClearScreen()
+		self.invalidate_drawn_lines()
 		self.RedrawNonAtomic()
 		self.loop.EndAtomicUpdate()
 		return
@@ -87,19 +87,11 @@ type InputState struct {
 	cursor Position
 }
 
-func (self InputState) copy() InputState {
-	ans := self
-	l := make([]string, len(self.lines))
-	copy(l, self.lines)
-	ans.lines = l
-	return ans
-}
-
 type syntax_highlighted struct {
-	lines                  []string
-	src_for_last_highlight string
-	highlighter            SyntaxHighlightFunction
-	last_highlighter_name  string
+	lines                 []string
+	generation            uint64
+	highlighter           SyntaxHighlightFunction
+	last_highlighter_name string
 }
 
 type Readline struct {
@@ -122,6 +114,13 @@ type Readline struct {
 	fmt_ctx                *markup.Context
 	text_to_be_added       string
 	syntax_highlighted     syntax_highlighted
+	// Incremented every time the input text changes
+	text_generation uint64
+	// Cached wrapping of input lines into screen lines
+	wrap_cache []wrapped_line
+	// The screen lines as last drawn, used to redraw only what changed
+	drawn_screen_lines []*ScreenLine
+	drawn_screen_width int
 }
 
 func (self *Readline) make_prompt(text string, is_secondary bool) Prompt {
@@ -158,8 +157,18 @@ func (self *Readline) SetPrompt(prompt string) {
 	self.prompt = self.make_prompt(prompt, false)
 }
 
+func (self *Readline) text_changed() {
+	self.text_generation++
+}
+
+func (self *Readline) invalidate_drawn_lines() {
+	self.drawn_screen_lines = nil
+}
+
 func (self *Readline) ResetText() {
 	self.input_state = InputState{lines: []string{""}}
+	self.text_changed()
+	self.invalidate_drawn_lines()
 	self.last_action = ActionNil
 	self.keyboard_state = KeyboardState{}
 	self.cursor_y = 0
@@ -173,6 +182,7 @@ func (self *Readline) ChangeLoopAndResetText(lp *loop.Loop) {
 func (self *Readline) Start() {
 	self.loop.SetCursorShape(loop.BAR_CURSOR, true)
 	self.loop.StartBracketedPaste()
+	self.invalidate_drawn_lines()
 	self.Redraw()
 }
 
@@ -232,6 +242,7 @@ func (self *Readline) SetText(text string) {
 
 func (self *Readline) OnResize(old_size loop.ScreenSize, new_size loop.ScreenSize) error {
 	self.screen_width, self.screen_height = 0, 0
+	self.invalidate_drawn_lines()
 	self.Redraw()
 	return nil
 }
@@ -52,16 +52,53 @@ func (self *Readline) prompt_for_line_number(i int) Prompt {
 	return self.continuation_prompt
 }
 
+func (self *ScreenLine) has_same_content(other *ScreenLine) bool {
+	return self.AfterLineBreak == other.AfterLineBreak && self.Prompt.Text == other.Prompt.Text && self.Text == other.Text
+}
+
+type wrapped_segment struct {
+	offset, length, width int
+}
+
+type wrapped_line struct {
+	src                       string
+	first_width, other_widths int
+	segments                  []wrapped_segment
+}
+
+// Split line into segments that fit on the screen, re-using the cached
+// result when neither the line nor the available width has changed since
+// the last call, so that only edited lines have their widths re-calculated.
+func (self *Readline) wrap_line(i int, line string, first_width, other_widths int) []wrapped_segment {
+	for len(self.wrap_cache) <= i {
+		self.wrap_cache = append(self.wrap_cache, wrapped_line{})
+	}
+	c := &self.wrap_cache[i]
+	if c.segments != nil && c.first_width == first_width && c.other_widths == other_widths && c.src == line {
+		return c.segments
+	}
+	c.src, c.first_width, c.other_widths = line, first_width, other_widths
+	c.segments = c.segments[:0]
+	offset, avail := 0, first_width
+	for is_first := true; is_first || offset < len(line); is_first = false {
+		l, width := wcswidth.TruncateToVisualLengthWithWidth(line[offset:], avail)
+		c.segments = append(c.segments, wrapped_segment{offset: offset, length: len(l), width: width})
+		offset += len(l)
+		avail = other_widths
+	}
+	return c.segments
+}
+
 func (self *Readline) apply_syntax_highlighting() (lines []string, cursor Position) {
 	highlighter := self.syntax_highlighted.highlighter
 	highlighter_name := "default"
 	if highlighter == nil {
 		return self.input_state.lines, self.input_state.cursor
 	}
-	src := strings.Join(self.input_state.lines, "\n")
-	if len(self.syntax_highlighted.lines) > 0 && self.syntax_highlighted.last_highlighter_name == highlighter_name && self.syntax_highlighted.src_for_last_highlight == src {
+	if len(self.syntax_highlighted.lines) > 0 && self.syntax_highlighted.last_highlighter_name == highlighter_name && self.syntax_highlighted.generation == self.text_generation {
 		lines = self.syntax_highlighted.lines
 	} else {
+		src := strings.Join(self.input_state.lines, "\n")
 		if src == "" {
 			lines = []string{""}
 		} else {
@@ -71,6 +108,9 @@ func (self *Readline) apply_syntax_highlighting() (lines []string, cursor Positi
 				lines = append(lines, "syntax highlighter malfunctioned")
 			}
 		}
+		self.syntax_highlighted.lines = lines
+		self.syntax_highlighted.generation = self.text_generation
+		self.syntax_highlighted.last_highlighter_name = highlighter_name
 	}
 	line := lines[self.input_state.cursor.Y]
 	w := wcswidth.Stringwidth(self.input_state.lines[self.input_state.cursor.Y][:self.input_state.cursor.X])
@@ -83,19 +123,22 @@ func (self *Readline) get_screen_lines() []*ScreenLine {
 		self.update_current_screen_size()
 	}
 	lines, cursor := self.apply_syntax_highlighting()
+	if len(self.wrap_cache) > len(lines) {
+		self.wrap_cache = self.wrap_cache[:len(lines)]
+	}
 	ans := make([]*ScreenLine, 0, len(lines))
 	found_cursor := false
 	cursor_at_start_of_next_line := false
 	for i, line := range lines {
 		prompt := self.prompt_for_line_number(i)
-		offset := 0
 		has_cursor := i == cursor.Y
-		for is_first := true; is_first || offset < len(line); is_first = false {
-			l, width := wcswidth.TruncateToVisualLengthWithWidth(line[offset:], self.screen_width-prompt.Length)
+		for _, seg := range self.wrap_line(i, line, self.screen_width-prompt.Length, self.screen_width) {
+			offset := seg.offset
+			l := line[offset : offset+seg.length]
 			sl := ScreenLine{
 				ParentLineNumber: i, OffsetInParentLine: offset,
-				Prompt: prompt, TextLengthInCells: width,
-				CursorCell: -1, Text: l, CursorTextPos: -1, AfterLineBreak: is_first,
+				Prompt: prompt, TextLengthInCells: seg.width,
+				CursorCell: -1, Text: l, CursorTextPos: -1, AfterLineBreak: offset == 0,
 			}
 			if cursor_at_start_of_next_line {
 				cursor_at_start_of_next_line = false
@@ -120,12 +163,27 @@ func (self *Readline) get_screen_lines() []*ScreenLine {
 				}
 			}
 			prompt = Prompt{}
-			offset += len(l)
 		}
 	}
 	return ans
 }
 
+// Each screen line occupies exactly one row on the screen, so only the rows
+// from the first screen line that differs from what was last drawn need to
+// be re-written.
+func (self *Readline) first_changed_screen_line(screen_lines []*ScreenLine) int {
+	if self.drawn_screen_lines == nil || self.drawn_screen_width != self.screen_width {
+		return 0
+	}
+	n := min(len(screen_lines), len(self.drawn_screen_lines))
+	for i := 0; i < n; i++ {
+		if !screen_lines[i].has_same_content(self.drawn_screen_lines[i]) {
+			return i
+		}
+	}
+	return n
+}
+
 func (self *Readline) redraw() {
 	if self.screen_width == 0 || self.screen_height == 0 {
 		self.update_current_screen_size()
@@ -133,59 +191,56 @@ func (self *Readline) redraw() {
 	if self.screen_width < 4 {
 		return
 	}
-	if self.cursor_y > 0 {
-		self.loop.MoveCursorVertically(-self.cursor_y)
-	}
-	self.loop.QueueWriteString("\r")
-	self.loop.ClearToEndOfScreen()
 	prompt_lines := self.get_screen_lines()
-	final_cursor_x := -1
-	cursor_y := 0
-	move_cursor_up_by := 0
-
-	self.loop.QueueWriteString("\r")
-	text_length := 0
-
-	for i, sl := range prompt_lines {
-		cursor_moved_down := false
-		if i > 0 && sl.AfterLineBreak {
-			self.loop.QueueWriteString("\r\n")
-			cursor_moved_down = true
-			text_length = 0
+	first := self.first_changed_screen_line(prompt_lines)
+	num_drawn := len(self.drawn_screen_lines)
+	current_row := self.cursor_y
+	if self.drawn_screen_lines == nil || first < len(prompt_lines) || first < num_drawn {
+		// Rows below the last drawn one do not exist yet and cursor down is
+		// clamped at the bottom of the screen, so move no further than the
+		// last drawn row and create new rows with \r\n
+		start_row := min(first, max(0, num_drawn-1))
+		self.loop.MoveCursorVertically(start_row - self.cursor_y)
+		self.loop.QueueWriteString("\r")
+		current_row = start_row
+		if first == start_row {
+			self.loop.ClearToEndOfScreen()
 		}
-		if sl.Prompt.Length > 0 {
-			p := self.prompt_for_line_number(i)
-			self.loop.QueueWriteString(p.Text)
-			text_length += p.Length
-		}
-		self.loop.QueueWriteString(sl.Text)
-		text_length += sl.TextLengthInCells
-		if text_length == self.screen_width && sl.Text == "" && i == len(prompt_lines)-1 {
-			self.loop.QueueWriteString("\r\n")
-			cursor_moved_down = true
-			text_length = 0
-		}
-		if text_length > self.screen_width {
-			cursor_moved_down = true
-			text_length -= self.screen_width
-		}
-		if sl.CursorCell > -1 {
-			final_cursor_x = sl.CursorCell
-		} else if final_cursor_x > -1 {
-			if cursor_moved_down {
-				move_cursor_up_by++
+		text_length := 0
+
+		for i := first; i < len(prompt_lines); i++ {
+			sl := prompt_lines[i]
+			if i > start_row && (i == first || sl.AfterLineBreak) {
+				self.loop.QueueWriteString("\r\n")
+				text_length = 0
+			}
+			if sl.Prompt.Length > 0 {
+				self.loop.QueueWriteString(sl.Prompt.Text)
+				text_length += sl.Prompt.Length
+			}
+			self.loop.QueueWriteString(sl.Text)
+			text_length += sl.TextLengthInCells
+			if text_length == self.screen_width && sl.Text == "" && i == len(prompt_lines)-1 {
+				self.loop.QueueWriteString("\r\n")
+				text_length = 0
+			}
+			if text_length > self.screen_width {
+				text_length -= self.screen_width
 			}
+			current_row = i
 		}
-		if cursor_moved_down {
-			cursor_y++
+	}
+	final_cursor_x, cursor_row := -1, len(prompt_lines)-1
+	for i, sl := range prompt_lines {
+		if sl.CursorCell > -1 {
+			final_cursor_x, cursor_row = sl.CursorCell, i
+			break
 		}
 	}
-	self.loop.MoveCursorVertically(-move_cursor_up_by)
+	self.loop.MoveCursorVertically(cursor_row - current_row)
 	self.loop.QueueWriteString("\r")
 	self.loop.MoveCursorHorizontally(final_cursor_x)
-	self.cursor_y = 0
-	cursor_y -= move_cursor_up_by
-	if cursor_y > 0 {
-		self.cursor_y = cursor_y
-	}
+	self.cursor_y = cursor_row
+	self.drawn_screen_lines = prompt_lines
+	self.drawn_screen_width = self.screen_width
 }
@@ -4,31 +4,170 @@ package utils
 
 import (
 	"container/list"
+	"fmt"
+	"hash/maphash"
 	"sync"
 )
 
-type LRUCache[K comparable, V any] struct {
-	data     map[K]V
-	lock     sync.RWMutex
+type lru_item[K comparable, V any] struct {
+	key K
+	val V
+}
+
+// A pending creation of a value, concurrent lookups of the same key wait on it
+// rather than creating the value again
+type lru_pending[V any] struct {
+	done chan struct{}
+	val  V
+	err  error
+}
+
+type lru_shard[K comparable, V any] struct {
+	lock     sync.Mutex
+	data     map[K]*list.Element
+	lru      *list.List // most recently used item at the front
+	pending  map[K]*lru_pending[V]
 	max_size int
-	lru      *list.List
+}
+
+// A cache that holds at most max_size items, evicting the least recently used
+// items when full. It is optionally split into independently locked shards, to
+// reduce lock contention, in which case the LRU order is per shard.
+type LRUCache[K comparable, V any] struct {
+	shards []lru_shard[K, V]
+	hash   func(K) uint64
 }
 
 func NewLRUCache[K comparable, V any](max_size int) *LRUCache[K, V] {
-	ans := LRUCache[K, V]{data: map[K]V{}, max_size: max_size, lru: list.New()}
+	return NewShardedLRUCache[K, V](max_size, 1, nil)
+}
+
+// Create a cache split into num_shards shards, keys are assigned to shards using hash.
+func NewShardedLRUCache[K comparable, V any](max_size, num_shards int, hash func(K) uint64) *LRUCache[K, V] {
+	if num_shards < 1 || hash == nil {
+		num_shards = 1
+	}
+	per_shard := max(1, (max_size+num_shards-1)/num_shards)
+	ans := LRUCache[K, V]{shards: make([]lru_shard[K, V], num_shards), hash: hash}
+	for i := range ans.shards {
+		s := &ans.shards[i]
+		s.data = make(map[K]*list.Element)
+		s.lru = list.New()
+		s.pending = make(map[K]*lru_pending[V])
+		s.max_size = per_shard
+	}
 	return &ans
 }
 
+var string_hash_seed = maphash.MakeSeed()
+
+// A hash function for string keys, suitable for use with NewShardedLRUCache
+func HashString(s string) uint64 {
+	return maphash.String(string_hash_seed, s)
+}
+
+func (self *LRUCache[K, V]) shard_for(key K) *lru_shard[K, V] {
+	if len(self.shards) == 1 {
+		return &self.shards[0]
+	}
+	return &self.shards[self.hash(key)%uint64(len(self.shards))]
+}
+
+// must be called with the lock held
+func (self *lru_shard[K, V]) add(key K, val V) {
+	if e, found := self.data[key]; found {
+		e.Value.(*lru_item[K, V]).val = val
+		self.lru.MoveToFront(e)
+		return
+	}
+	for self.lru.Len() >= self.max_size {
+		oldest := self.lru.Back()
+		self.lru.Remove(oldest)
+		delete(self.data, oldest.Value.(*lru_item[K, V]).key)
+	}
+	self.data[key] = self.lru.PushFront(&lru_item[K, V]{key: key, val: val})
+}
+
+func (self *LRUCache[K, V]) Get(key K) (ans V, found bool) {
+	s := self.shard_for(key)
+	s.lock.Lock()
+	defer s.lock.Unlock()
+	if e, ok := s.data[key]; ok {
+		s.lru.MoveToFront(e)
+		return e.Value.(*lru_item[K, V]).val, true
+	}
+	return
+}
+
+func (self *LRUCache[K, V]) Set(key K, val V) {
+	s := self.shard_for(key)
+	s.lock.Lock()
+	defer s.lock.Unlock()
+	s.add(key, val)
+}
+
+func (self *LRUCache[K, V]) Len() (ans int) {
+	for i := range self.shards {
+		s := &self.shards[i]
+		s.lock.Lock()
+		ans += s.lru.Len()
+		s.lock.Unlock()
+	}
+	return
+}
+
+func (self *LRUCache[K, V]) Clear() {
+	for i := range self.shards {
+		s := &self.shards[i]
+		s.lock.Lock()
+		clear(s.data)
+		s.lru.Init()
+		s.lock.Unlock()
+	}
+}
+
+// Return the cached value for key, calling create to make it if it is not
+// present. Concurrent calls for the same missing key call create only once,
+// the others wait for its result. Errors are returned to all waiting callers
+// but are not cached.
+func (self *LRUCache[K, V]) GetOrCreate(key K, create func(key K) (V, error)) (V, error) {
+	s := self.shard_for(key)
+	s.lock.Lock()
+	if e, found := s.data[key]; found {
+		s.lru.MoveToFront(e)
+		s.lock.Unlock()
+		return e.Value.(*lru_item[K, V]).val, nil
+	}
+	if p, found := s.pending[key]; found {
+		s.lock.Unlock()
+		<-p.done
+		return p.val, p.err
+	}
+	p := &lru_pending[V]{done: make(chan struct{})}
+	s.pending[key] = p
+	s.lock.Unlock()
+	completed := false
+	defer func() {
+		// runs even if create panics so that waiters are not blocked forever
+		if !completed {
+			p.err = fmt.Errorf("creating the cached value for %v failed with a panic", key)
+		}
+		s.lock.Lock()
+		delete(s.pending, key)
+		s.lock.Unlock()
+		close(p.done)
+	}()
+	p.val, p.err = create(key)
+	completed = true
+	if p.err == nil {
+		s.lock.Lock()
+		s.add(key, p.val)
+		s.lock.Unlock()
+	}
+	return p.val, p.err
+}
+
 func (self *LRUCache[K, V]) MustGetOrCreate(key K, create func(key K) V) V {
-	self.lock.RLock()
-	ans, found := self.data[key]
-	self.lock.RUnlock()
-	if found {
-		return ans
-	}
-	ans = create(key)
-	self.lock.Lock()
-	self.data[key] = ans
-	self.lock.Unlock()
+	ans, _ := self.GetOrCreate(key, func(key K) (V, error) { return create(key), nil })
 	return ans
 }
@@ -0,0 +1,147 @@
+// License: GPLv3 Copyright: 2026, alatty contributors
+
+package utils
+
+import (
+	"errors"
+	"fmt"
+	"strconv"
+	"sync"
+	"sync/atomic"
+	"testing"
+)
+
+func TestLRUCacheEviction(t *testing.T) {
+	c := NewLRUCache[int, int](3)
+	for i := 0; i < 3; i++ {
+		c.Set(i, i)
+	}
+	c.Get(0)     // 0 is now the most recently used, 1 the least
+	c.Set(2, 20) // updating a value also marks it as used, the order is now 2, 0, 1
+	c.Set(3, 3)
+	if _, found := c.Get(1); found {
+		t.Fatalf("The least recently used item was not evicted")
+	}
+	c.Set(4, 4)
+	for key, expected := range map[int]int{2: 20, 3: 3, 4: 4} {
+		if val, found := c.Get(key); !found || val != expected {
+			t.Fatalf("Get(%d) = (%d, %v), expected (%d, true)", key, val, found, expected)
+		}
+	}
+	for _, key := range []int{0, 1} {
+		if _, found := c.Get(key); found {
+			t.Fatalf("%d was not evicted", key)
+		}
+	}
+	if c.Len() != 3 {
+		t.Fatalf("Len() = %d, expected 3", c.Len())
+	}
+	c.Clear()
+	if c.Len() != 0 {
+		t.Fatalf("Len() = %d after Clear()", c.Len())
+	}
+
+	s := NewShardedLRUCache[string, int](16, 4, HashString)
+	for i := 0; i < 100; i++ {
+		s.Set(strconv.Itoa(i), i)
+	}
+	if s.Len() > 16 {
+		t.Fatalf("Sharded cache holds %d items, more than its maximum of 16", s.Len())
+	}
+	if val, found := s.Get("99"); !found || val != 99 {
+		t.Fatalf("The most recently added item is missing from the sharded cache")
+	}
+}
+
+func TestLRUCacheGetOrCreateCreatesOnce(t *testing.T) {
+	c := NewShardedLRUCache[string, int](16, 4, HashString)
+	var calls atomic.Int32
+	release := make(chan struct{})
+	create := func(key string) (int, error) {
+		calls.Add(1)
+		<-release
+		return len(key), nil
+	}
+	const num = 64
+	var started, finished sync.WaitGroup
+	results := make([]int, num)
+	for i := 0; i < num; i++ {
+		started.Add(1)
+		finished.Add(1)
+		go func(i int) {
+			defer finished.Done()
+			started.Done()
+			results[i], _ = c.GetOrCreate("key", create)
+		}(i)
+	}
+	started.Wait()
+	close(release)
+	finished.Wait()
+	if n := calls.Load(); n != 1 {
+		t.Fatalf("create was called %d times", n)
+	}
+	for i, val := range results {
+		if val != 3 {
+			t.Fatalf("Caller %d got %d", i, val)
+		}
+	}
+}
+
+func TestLRUCacheErrorsAreNotCached(t *testing.T) {
+	c := NewLRUCache[string, int](16)
+	fail := errors.New("failed")
+	calls := 0
+	create := func(key string) (int, error) {
+		calls++
+		if calls == 1 {
+			return 0, fail
+		}
+		return 1, nil
+	}
+	if _, err := c.GetOrCreate("key", create); err != fail {
+		t.Fatalf("GetOrCreate() returned error %v, expected %v", err, fail)
+	}
+	if c.Len() != 0 {
+		t.Fatalf("A failed creation was cached")
+	}
+	for i := 0; i < 2; i++ {
+		if val, err := c.GetOrCreate("key", create); err != nil || val != 1 {
+			t.Fatalf("GetOrCreate() = (%d, %v) after a failure", val, err)
+		}
+	}
+	if calls != 2 {
+		t.Fatalf("create was called %d times, expected 2", calls)
+	}
+
+	// a panicking create must not leave other callers waiting forever
+	func() {
+		defer func() { _ = recover() }()
+		c.GetOrCreate("panic", func(string) (int, error) { panic("create") })
+	}()
+	if val, err := c.GetOrCreate("panic", func(string) (int, error) { return 2, nil }); err != nil || val != 2 {
+		t.Fatalf("GetOrCreate() = (%d, %v) after a panic", val, err)
+	}
+}
+
+func BenchmarkGetOrCreate(b *testing.B) {
+	keys := make([]string, 2048)
+	for i := range keys {
+		keys[i] = fmt.Sprintf("fg=color%d bold", i)
+	}
+	create := func(key string) (int, error) { return len(key), nil }
+	for _, num_shards := range []int{1, 8} {
+		b.Run(fmt.Sprintf("shards=%d", num_shards), func(b *testing.B) {
+			c := NewShardedLRUCache[string, int](1024, num_shards, HashString)
+			var next atomic.Uint32
+			b.ReportAllocs()
+			b.RunParallel(func(pb *testing.PB) {
+				// each goroutine starts at a different point, mostly hitting the cache
+				i := int(next.Add(97))
+				for pb.Next() {
+					c.GetOrCreate(keys[i%768], create)
+					i++
+				}
+			})
+		})
+	}
+}
@@ -6,8 +6,8 @@ import (
 	"fmt"
 	"strconv"
 	"strings"
-	"sync"
 
+	"alatty/tools/utils"
 	"alatty/tools/utils/shlex"
 )
 
@@ -329,18 +329,10 @@ func parse_spec(spec string) []escape_code {
 	return ans
 }
 
-var parsed_spec_cache = make(map[string][]escape_code)
-var parsed_spec_cache_mutex = sync.Mutex{}
+var parsed_spec_cache = utils.NewShardedLRUCache[string, []escape_code](1024, 8, utils.HashString)
 
 func cached_parse_spec(spec string) []escape_code {
-	parsed_spec_cache_mutex.Lock()
-	defer parsed_spec_cache_mutex.Unlock()
-	if val, ok := parsed_spec_cache[spec]; ok {
-		return val
-	}
-	ans := parse_spec(spec)
-	parsed_spec_cache[spec] = ans
-	return ans
+	return parsed_spec_cache.MustGetOrCreate(spec, parse_spec)
 }
 
 func prefix_for_spec(spec string) string {
@@ -3,28 +3,31 @@
 package wcswidth
 
 import (
-	"errors"
 	"fmt"
 	"strconv"
+	"sync"
 
 	"alatty/tools/utils"
 )
 
 var _ = fmt.Print
 
-type truncate_error struct {
-	pos, width int
-}
-
-func (self *truncate_error) Error() string {
-	return fmt.Sprint("Truncation at:", self.pos, " with width:", self.width)
-}
-
 type truncate_iterator struct {
 	w WCWidthIterator
 
-	pos, limit        int
-	limit_exceeded_at *truncate_error
+	pos, limit int
+	// Set once the limit has been exceeded, parsing continues until the next
+	// character to account for variation selectors reducing the width
+	limit_exceeded                           bool
+	limit_exceeded_pos, limit_exceeded_width int
+	// Set when the truncation point has been found, parsing stops immediately
+	done                         bool
+	truncate_pos, truncate_width int
+}
+
+func (self *truncate_iterator) truncate_at(pos, width int) {
+	self.done = true
+	self.truncate_pos, self.truncate_width = pos, width
 }
 
 func (self *truncate_iterator) handle_csi(csi []byte) error {
@@ -36,7 +39,8 @@ func (self *truncate_iterator) handle_csi(csi []byte) error {
 			for ; n > 0; n-- {
 				self.w.handle_rune(self.w.prev_ch)
 				if self.w.current_width > self.limit {
-					return &truncate_error{pos: self.pos, width: width_before_repeat}
+					self.truncate_at(self.pos, width_before_repeat)
+					return nil
 				}
 			}
 		}
@@ -61,30 +65,43 @@ func create_truncate_iterator() *truncate_iterator {
 	return &ans
 }
 
+// Iterators are reused as creating one allocates its parser callbacks
+var truncate_iterator_pool = sync.Pool{New: func() any { return create_truncate_iterator() }}
+
+func (self *truncate_iterator) reset(limit int) {
+	self.w.Reset()
+	self.pos, self.limit = 0, limit
+	self.limit_exceeded, self.done = false, false
+}
+
 func (self *truncate_iterator) handle_rune(ch rune) error {
 	width := self.w.current_width
 	self.w.handle_rune(ch)
-	if self.limit_exceeded_at != nil {
+	if self.limit_exceeded {
 		if self.w.current_width <= self.limit { // emoji variation selectors can cause width to decrease
-			return &truncate_error{pos: self.pos + len(string(ch)), width: self.w.current_width}
+			self.truncate_at(self.pos+len(string(ch)), self.w.current_width)
+		} else {
+			self.truncate_at(self.limit_exceeded_pos, self.limit_exceeded_width)
 		}
-		return self.limit_exceeded_at
+		return nil
 	}
 	if self.w.current_width > self.limit {
-		self.limit_exceeded_at = &truncate_error{pos: self.pos, width: width}
+		self.limit_exceeded = true
+		self.limit_exceeded_pos, self.limit_exceeded_width = self.pos, width
 	}
 	self.pos += len(string(ch))
 	return nil
 }
 
 func (self *truncate_iterator) parse(b []byte) (ans int, width int) {
-	err := self.w.parser.Parse(b)
-	var te *truncate_error
-	if err != nil && errors.As(err, &te) {
-		return te.pos, te.width
+	for _, ch := range b {
+		self.w.parser.ParseByte(ch)
+		if self.done {
+			return self.truncate_pos, self.truncate_width
+		}
 	}
-	if self.limit_exceeded_at != nil {
-		return self.limit_exceeded_at.pos, self.limit_exceeded_at.width
+	if self.limit_exceeded {
+		return self.limit_exceeded_pos, self.limit_exceeded_width
 	}
 	return len(b), self.w.current_width
 }
@@ -93,10 +110,15 @@ func TruncateToVisualLengthWithWidth(text string, length int) (truncated string,
 	if length < 1 {
 		return text[:0], 0
 	}
-	t := create_truncate_iterator()
-	t.limit = length
-	t.limit_exceeded_at = nil
-	t.w.current_width = 0
+	if is_printable_ascii(text) {
+		if len(text) > length {
+			return text[:length], length
+		}
+		return text, len(text)
+	}
+	t := truncate_iterator_pool.Get().(*truncate_iterator)
+	defer truncate_iterator_pool.Put(t)
+	t.reset(length)
 	truncate_point, width := t.parse(utils.UnsafeStringToBytes(text))
 	return text[:truncate_point], width
 }
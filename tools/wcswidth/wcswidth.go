@@ -6,6 +6,7 @@ import (
 	"fmt"
 	"strconv"
 	"strings"
+	"sync"
 
 	"alatty/tools/utils"
 )
@@ -42,6 +43,7 @@ func (self *WCWidthIterator) Reset() {
 	self.prev_width = 0
 	self.current_width = 0
 	self.rune_count = 0
+	self.state = 0
 	self.parser.Reset()
 }
 
@@ -126,8 +128,26 @@ func (self *WCWidthIterator) CurrentWidth() int {
 	return self.current_width
 }
 
+// Iterators are reused as creating one allocates its parser callbacks
+var width_iterator_pool = sync.Pool{New: func() any { return CreateWCWidthIterator() }}
+
+// Printable ASCII text has no escape codes and a width of one cell per byte
+func is_printable_ascii(text string) bool {
+	for i := 0; i < len(text); i++ {
+		if text[i] < 0x20 || text[i] > 0x7e {
+			return false
+		}
+	}
+	return true
+}
+
 func Stringwidth(text string) int {
-	w := CreateWCWidthIterator()
+	if is_printable_ascii(text) {
+		return len(text)
+	}
+	w := width_iterator_pool.Get().(*WCWidthIterator)
+	defer width_iterator_pool.Put(w)
+	w.Reset()
 	return w.Parse(utils.UnsafeStringToBytes(text))
 }
 
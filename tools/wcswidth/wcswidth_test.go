@@ -0,0 +1,160 @@
+// License: GPLv3 Copyright: 2026, alatty contributors
+
+package wcswidth
+
+import (
+	"errors"
+	"math/rand"
+	"strconv"
+	"strings"
+	"testing"
+
+	"alatty/tools/utils"
+)
+
+// The implementations below are the ones from before iterators were pooled and
+// truncation stopped reporting its cut point with errors. They create a new
+// iterator for every call and are used as the reference for the current ones.
+
+func reference_stringwidth(text string) int {
+	return CreateWCWidthIterator().Parse(utils.UnsafeStringToBytes(text))
+}
+
+type reference_truncate_error struct {
+	pos, width int
+}
+
+func (self *reference_truncate_error) Error() string {
+	return "truncated at: " + strconv.Itoa(self.pos)
+}
+
+type reference_truncate_iterator struct {
+	w WCWidthIterator
+
+	pos, limit        int
+	limit_exceeded_at *reference_truncate_error
+}
+
+func (self *reference_truncate_iterator) handle_csi(csi []byte) error {
+	if len(csi) > 1 && csi[len(csi)-1] == 'b' {
+		n, err := strconv.Atoi(utils.UnsafeBytesToString(csi[:len(csi)-1]))
+		if err == nil && n > 0 {
+			width_before_repeat := self.w.current_width
+			for ; n > 0; n-- {
+				self.w.handle_rune(self.w.prev_ch)
+				if self.w.current_width > self.limit {
+					return &reference_truncate_error{pos: self.pos, width: width_before_repeat}
+				}
+			}
+		}
+	}
+	self.pos += len(csi) + 2
+	return nil
+}
+
+func (self *reference_truncate_iterator) handle_st_terminated_escape_code(body []byte) error {
+	self.pos += len(body) + 4
+	return nil
+}
+
+func (self *reference_truncate_iterator) handle_rune(ch rune) error {
+	width := self.w.current_width
+	self.w.handle_rune(ch)
+	if self.limit_exceeded_at != nil {
+		if self.w.current_width <= self.limit {
+			return &reference_truncate_error{pos: self.pos + len(string(ch)), width: self.w.current_width}
+		}
+		return self.limit_exceeded_at
+	}
+	if self.w.current_width > self.limit {
+		self.limit_exceeded_at = &reference_truncate_error{pos: self.pos, width: width}
+	}
+	self.pos += len(string(ch))
+	return nil
+}
+
+func reference_truncate(text string, length int) (string, int) {
+	if length < 1 {
+		return text[:0], 0
+	}
+	t := reference_truncate_iterator{limit: length}
+	t.w.parser.HandleRune = t.handle_rune
+	t.w.parser.HandleCSI = t.handle_csi
+	t.w.parser.HandleOSC = t.handle_st_terminated_escape_code
+	t.w.parser.HandleAPC = t.handle_st_terminated_escape_code
+	t.w.parser.HandlePM = t.handle_st_terminated_escape_code
+	t.w.parser.HandleSOS = t.handle_st_terminated_escape_code
+	err := t.w.parser.Parse(utils.UnsafeStringToBytes(text))
+	var te *reference_truncate_error
+	if err != nil && errors.As(err, &te) {
+		return text[:te.pos], te.width
+	}
+	if t.limit_exceeded_at != nil {
+		return text[:t.limit_exceeded_at.pos], t.limit_exceeded_at.width
+	}
+	return text, t.w.current_width
+}
+
+var text_fragments = []string{
+	"a", "xyz", " ", "ab cd", "\t", "\x1b[31m", "\x1b[m", "\x1b[3b", "\x1b[12b", "\x1b]8;;https://example.com\x1b\\",
+	"\x1b_Gi=1\x1b\\", "中", "文字", "é", "👍", "❤", "️", "︎", "🇺", "🇸", "🇺🇸", "\xff", "\xe4\xb8", "\x7f",
+}
+
+func random_text(r *rand.Rand) string {
+	var b strings.Builder
+	for n := r.Intn(12); n > 0; n-- {
+		b.WriteString(text_fragments[r.Intn(len(text_fragments))])
+	}
+	return b.String()
+}
+
+func TestStringwidthMatchesReference(t *testing.T) {
+	r := rand.New(rand.NewSource(1))
+	for i := 0; i < 100000; i++ {
+		text := random_text(r)
+		if expected, actual := reference_stringwidth(text), Stringwidth(text); expected != actual {
+			t.Fatalf("Stringwidth(%q) = %d, expected %d", text, actual, expected)
+		}
+	}
+}
+
+func TestTruncateMatchesReference(t *testing.T) {
+	r := rand.New(rand.NewSource(2))
+	for i := 0; i < 100000; i++ {
+		text := random_text(r)
+		length := r.Intn(reference_stringwidth(text)+3) - 1
+		expected, expected_width := reference_truncate(text, length)
+		actual, actual_width := TruncateToVisualLengthWithWidth(text, length)
+		if expected != actual || expected_width != actual_width {
+			t.Fatalf("TruncateToVisualLengthWithWidth(%q, %d) = (%q, %d), expected (%q, %d)", text, length, actual, actual_width, expected, expected_width)
+		}
+	}
+}
+
+var benchmark_texts = map[string]string{
+	"ascii": "The quick brown fox jumps over the lazy dog, 0123456789",
+	"mixed": "\x1b[1;32m❯\x1b[m ~/src/alatty \x1b[33m(master)\x1b[m 中文字 👍🏽 🇺🇸 é \x1b]8;;https://example.com\x1b\\link\x1b]8;;\x1b\\",
+}
+
+func BenchmarkStringwidth(b *testing.B) {
+	for name, text := range benchmark_texts {
+		b.Run(name, func(b *testing.B) {
+			b.ReportAllocs()
+			for i := 0; i < b.N; i++ {
+				Stringwidth(text)
+			}
+		})
+	}
+}
+
+func BenchmarkTruncate(b *testing.B) {
+	for name, text := range benchmark_texts {
+		limit := Stringwidth(text) / 2
+		b.Run(name, func(b *testing.B) {
+			b.ReportAllocs()
+			for i := 0; i < b.N; i++ {
+				TruncateToVisualLengthWithWidth(text, limit)
+			}
+		})
+	}
+}